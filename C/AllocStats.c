@@ -0,0 +1,129 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define ALLOCSTATS_IMPLEMENTATION
+#include "AllocStats.h"
+#include <string.h>
+
+static AllocStats counters;
+
+// 16 bytes keep the alignment malloc guarantees on 64 bit platforms
+#define HEADER 16
+
+unsigned long long AllocStats_sizeClassLimit(int sizeClass)
+{
+    return 16ULL << sizeClass;
+}
+
+static int sizeClass(size_t size)
+{
+    int c = 0;
+    while( c < ALLOCSTATS_SIZE_CLASSES - 1 && size > AllocStats_sizeClassLimit(c) )
+        c++;
+    return c;
+}
+
+#ifdef AWFY_ALLOC_STATS
+bool AllocStats_enabled()
+{
+    return true;
+}
+#else
+bool AllocStats_enabled()
+{
+    return false;
+}
+#endif
+
+AllocStats AllocStats_begin()
+{
+    counters.peak = counters.live;
+    return counters;
+}
+
+AllocStats AllocStats_end(const AllocStats* begin)
+{
+    AllocStats res;
+    res.allocations = counters.allocations - begin->allocations;
+    res.deallocations = counters.deallocations - begin->deallocations;
+    res.bytes = counters.bytes - begin->bytes;
+    res.live = counters.live;
+    res.peak = counters.peak > begin->live ? counters.peak - begin->live : 0;
+    for( int i = 0; i < ALLOCSTATS_SIZE_CLASSES; i++ )
+        res.histogram[i] = counters.histogram[i] - begin->histogram[i];
+    return res;
+}
+
+static void count(size_t size)
+{
+    counters.allocations++;
+    counters.bytes += size;
+    counters.live += size;
+    if( counters.live > counters.peak )
+        counters.peak = counters.live;
+    counters.histogram[sizeClass(size)]++;
+}
+
+void* AllocStats_malloc(size_t size)
+{
+    char* p = malloc(size + HEADER);
+    if( p == 0 )
+        return 0;
+    *(size_t*)p = size;
+    count(size);
+    return p + HEADER;
+}
+
+void* AllocStats_calloc(size_t n, size_t size)
+{
+    void* p = AllocStats_malloc(n * size);
+    if( p != 0 )
+        memset(p, 0, n * size);
+    return p;
+}
+
+void AllocStats_free(void* ptr)
+{
+    if( ptr == 0 )
+        return;
+    char* p = (char*)ptr - HEADER;
+    const size_t size = *(size_t*)p;
+    counters.deallocations++;
+    counters.live = counters.live > size ? counters.live - size : 0;
+    free(p);
+}
+
+void* AllocStats_realloc(void* ptr, size_t size)
+{
+    // counted as a deallocation and an allocation, as realloc usually moves the block
+    if( ptr == 0 )
+        return AllocStats_malloc(size);
+    char* p = (char*)ptr - HEADER;
+    const size_t old = *(size_t*)p;
+    char* q = realloc(p, size + HEADER);
+    if( q == 0 )
+        return 0;
+    *(size_t*)q = size;
+    counters.deallocations++;
+    counters.live = counters.live > old ? counters.live - old : 0;
+    count(size);
+    return q + HEADER;
+}
@@ -0,0 +1,63 @@
+#ifndef _ALLOCSTATS_H
+#define _ALLOCSTATS_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Compile switch for the allocation profiling build; when defined, the files which include
+// this header after the system headers have malloc, calloc, realloc and free redirected
+// to counting versions. Adds a 16 byte size header to each block, so the timing is affected.
+// #define AWFY_ALLOC_STATS
+
+// size classes 16, 32, .. 64K bytes (upper bounds inclusive), the last one collects the rest
+#define ALLOCSTATS_SIZE_CLASSES 14
+
+typedef struct AllocStats {
+    unsigned long long allocations;
+    unsigned long long deallocations;
+    unsigned long long bytes;       // requested bytes
+    unsigned long long live;        // bytes allocated but not yet freed
+    unsigned long long peak;        // highest live since the last AllocStats_begin
+    unsigned long long histogram[ALLOCSTATS_SIZE_CLASSES];
+} AllocStats;
+
+extern bool AllocStats_enabled();
+extern AllocStats AllocStats_begin();
+// difference since begin; peak is relative to the live bytes at begin
+extern AllocStats AllocStats_end(const AllocStats* begin);
+extern unsigned long long AllocStats_sizeClassLimit(int sizeClass);
+
+extern void* AllocStats_malloc(size_t size);
+extern void* AllocStats_calloc(size_t n, size_t size);
+extern void* AllocStats_realloc(void* ptr, size_t size);
+extern void AllocStats_free(void* ptr);
+
+#if defined(AWFY_ALLOC_STATS) && !defined(ALLOCSTATS_IMPLEMENTATION)
+#define malloc(size) AllocStats_malloc(size)
+#define calloc(count, size) AllocStats_calloc(count, size)
+#define realloc(ptr, size) AllocStats_realloc(ptr, size)
+#define free(ptr) AllocStats_free(ptr)
+#endif
+
+#endif // _ALLOCSTATS_H
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include "som/Random.h"
+#include "AllocStats.h"
 
 typedef struct Ball {
     int x;
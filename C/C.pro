@@ -13,6 +13,8 @@ SOURCES += \
     main.c \
     Benchmark.c \
     Run.c \
+    Clock.c \
+    AllocStats.c \
     Bounce.c \
     som/Random.c \
     Object.c \
@@ -37,6 +39,8 @@ SOURCES += \
 HEADERS += \
     Benchmark.h \
     Run.h \
+    Clock.h \
+    AllocStats.h \
     Bounce.h \
     som/Random.h \
     Object.h \
@@ -28,6 +28,7 @@
 #include <math.h>
 #include "som/Vector.h"
 #include <assert.h>
+#include "AllocStats.h"
 
 #define USE_FANCY_ITERATORS
 /* NOTE: virtually no difference with or without iterators.
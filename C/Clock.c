@@ -0,0 +1,329 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "Clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined __ECS_C__ || defined __ECS2_C__
+
+typedef struct timeval {
+    long tv_sec;
+    long tv_usec;
+} timeval;
+
+int gettimeofday(struct timeval * tp, struct timezone * tzp)
+{
+    struct timespec ts;
+    timespec_get(&ts,0);
+    tp->tv_sec = ts.tv_sec;
+    tp->tv_usec = ts.tv_nsec / 1000;
+}
+
+#elif defined(_WIN32) && !defined(__GNUC__)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+// Source: https://stackoverflow.com/questions/10905892/equivalent-of-gettimeday-for-windows/26085827
+
+// MSVC defines this in winsock2.h!?
+typedef struct timeval {
+    long tv_sec;
+    long tv_usec;
+} timeval;
+
+int gettimeofday(struct timeval * tp, struct timezone * tzp)
+{
+    // Note: some broken versions only have 8 trailing zero's, the correct epoch has 9 trailing zero's
+    // This magic number is the number of 100 nanosecond intervals since January 1, 1601 (UTC)
+    // until 00:00:00 January 1, 1970
+    static const uint64_t EPOCH = ((uint64_t) 116444736000000000ULL);
+
+    SYSTEMTIME  system_time;
+    FILETIME    file_time;
+    uint64_t    time;
+
+    GetSystemTime( &system_time );
+    SystemTimeToFileTime( &system_time, &file_time );
+    time =  ((uint64_t)file_time.dwLowDateTime )      ;
+    time += ((uint64_t)file_time.dwHighDateTime) << 32;
+
+    tp->tv_sec  = (long) ((time - EPOCH) / 10000000L);
+    tp->tv_usec = (long) (system_time.wMilliseconds * 1000);
+    return 0;
+}
+#define HAVE_QPC
+#else
+#include <sys/time.h>
+#define HAVE_CLOCK_GETTIME
+#endif
+
+#if !defined __ECS_C__ && !defined __ECS2_C__ && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define HAVE_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+#endif
+
+static Ticks gettimeofdayRead(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return (Ticks)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static Clock gettimeofdayClock = { "gettimeofday", gettimeofdayRead, gettimeofdayRead, 1000.0 };
+
+#ifdef HAVE_CLOCK_GETTIME
+static Ticks monotonicRead(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Ticks)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static Clock monotonicClock = { "monotonic", monotonicRead, monotonicRead, 1.0 };
+
+#ifdef CLOCK_MONOTONIC_RAW
+static Ticks monotonicRawRead(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (Ticks)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static Clock monotonicRawClock = { "monotonic_raw", monotonicRawRead, monotonicRawRead, 1.0 };
+#endif
+#endif
+
+#ifdef HAVE_QPC
+static Ticks qpcRead(void)
+{
+    LARGE_INTEGER c;
+    QueryPerformanceCounter(&c);
+    return c.QuadPart;
+}
+
+static Clock monotonicClock = { "monotonic", qpcRead, qpcRead, 1.0 };
+#endif
+
+static int compareDouble(const void* l, const void* r)
+{
+    const double lhs = *(const double*)l;
+    const double rhs = *(const double*)r;
+    return lhs < rhs ? -1 : lhs > rhs ? 1 : 0;
+}
+
+static double median(double* values, int n)
+{
+    qsort(values, n, sizeof(double), compareDouble);
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+}
+
+#ifdef HAVE_TSC
+
+// start fences so that earlier instructions have completed before the counter is
+// read; stop uses rdtscp, which waits for the measured code, and fences so that
+// later instructions cannot start early
+static Ticks tscStart(void)
+{
+    _mm_lfence();
+    const Ticks t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+static Ticks tscStop(void)
+{
+    unsigned int aux;
+    const Ticks t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+}
+
+static Clock tscClock = { "tsc", tscStart, tscStop, 0.0 };
+
+static bool tscInvariant(void)
+{
+    unsigned int regs[4] = { 0, 0, 0, 0 };
+#if defined(_MSC_VER)
+    __cpuid((int*)regs, 0x80000000);
+    if( regs[0] < 0x80000007 )
+        return false;
+    __cpuid((int*)regs, 0x80000007);
+#else
+    if( __get_cpuid_max(0x80000000, 0) < 0x80000007 )
+        return false;
+    __get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+    return (regs[3] & (1 << 8)) != 0;
+}
+
+// calibrate against the reference clock; the median of a few short rounds
+static void tscCalibrate(Clock* reference)
+{
+    const double window = 20.0e6; // ns
+    double rounds[5];
+    for( int i = 0; i < 5; i++ )
+    {
+        const Ticks r0 = reference->start();
+        const Ticks t0 = tscStart();
+        Ticks r1, t1;
+        do {
+            r1 = reference->stop();
+            t1 = tscStop();
+        } while( (r1 - r0) * reference->nanosecondsPerTick < window );
+        rounds[i] = (r1 - r0) * reference->nanosecondsPerTick / (t1 - t0);
+    }
+    tscClock.nanosecondsPerTick = median(rounds, 5);
+}
+#endif
+
+static Clock* defaultClock(void)
+{
+#ifdef HAVE_QPC
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    monotonicClock.nanosecondsPerTick = 1.0e9 / f.QuadPart;
+    return &monotonicClock;
+#elif defined HAVE_CLOCK_GETTIME
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_RAW
+    if( clock_gettime(CLOCK_MONOTONIC_RAW, &ts) == 0 )
+        return &monotonicRawClock;
+#endif
+    if( clock_gettime(CLOCK_MONOTONIC, &ts) == 0 )
+        return &monotonicClock;
+#endif
+    return &gettimeofdayClock;
+}
+
+static Clock* current = 0;
+
+bool Clock_select(const char* name)
+{
+    Clock* c = 0;
+    if( name == 0 || *name == 0 )
+        c = defaultClock();
+    else if( strcmp(name, "gettimeofday") == 0 )
+        c = &gettimeofdayClock;
+#if defined HAVE_CLOCK_GETTIME || defined HAVE_QPC
+    else if( strcmp(name, "monotonic") == 0 )
+    {
+        c = defaultClock();
+        if( c != &gettimeofdayClock )
+            c = &monotonicClock;
+        else
+            c = 0;
+    }
+#endif
+#if defined HAVE_CLOCK_GETTIME && defined CLOCK_MONOTONIC_RAW
+    else if( strcmp(name, "monotonic_raw") == 0 )
+    {
+        c = defaultClock();
+        if( c != &monotonicRawClock )
+            c = 0;
+    }
+#endif
+#ifdef HAVE_TSC
+    else if( strcmp(name, "tsc") == 0 )
+    {
+        tscCalibrate(defaultClock());
+        c = &tscClock;
+    }
+#endif
+    if( c == 0 )
+        return false;
+    current = c;
+    return true;
+}
+
+Clock* Clock_current()
+{
+    if( current == 0 )
+        Clock_select(0);
+    return current;
+}
+
+const char* Clock_available()
+{
+    return "monotonic_raw, monotonic, gettimeofday, tsc";
+}
+
+double Clock_toMicroseconds(Clock* me, Ticks elapsed)
+{
+    return elapsed * me->nanosecondsPerTick / 1000.0;
+}
+
+double Clock_resolution(Clock* me)
+{
+    double best = 0;
+    for( int i = 0; i < 100; i++ )
+    {
+        const Ticks t0 = me->start();
+        Ticks t1 = me->start();
+        while( t1 == t0 )
+            t1 = me->start();
+        const double d = (t1 - t0) * me->nanosecondsPerTick;
+        if( best == 0 || d < best )
+            best = d;
+    }
+    return best;
+}
+
+double Clock_overhead(Clock* me)
+{
+    enum { N = 1000 };
+    static double d[N];
+    for( int i = 0; i < N; i++ )
+    {
+        const Ticks t0 = me->start();
+        const Ticks t1 = me->stop();
+        d[i] = (t1 - t0) * me->nanosecondsPerTick;
+    }
+    return median(d, N);
+}
+
+void Clock_printInfo()
+{
+    Clock* c = Clock_current();
+    printf("Clock: %s resolution: %gns overhead: %gns", c->name, Clock_resolution(c), Clock_overhead(c));
+#ifdef HAVE_TSC
+    if( c == &tscClock )
+    {
+        printf(" frequency: %gGHz", 1.0 / c->nanosecondsPerTick);
+        if( !tscInvariant() )
+            printf(" (WARNING: TSC not invariant)");
+    }
+#endif
+    printf("\n");
+    fflush(stdout);
+}
@@ -0,0 +1,48 @@
+#ifndef _CLOCK_H
+#define _CLOCK_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+
+typedef unsigned long long Ticks;
+
+// Timer backend used by Run; start and stop are separate so that each side can
+// use the appropriate serialization (see the tsc clock in Clock.c).
+typedef struct Clock {
+    const char* name;
+    Ticks (*start)(void);
+    Ticks (*stop)(void);
+    double nanosecondsPerTick;
+} Clock;
+
+// selects the named clock or the default one if name is 0 or empty; returns false
+// if the name is unknown or the clock not supported on this machine
+extern bool Clock_select(const char* name);
+extern Clock* Clock_current();
+extern const char* Clock_available();
+extern double Clock_toMicroseconds(Clock* me, Ticks elapsed);
+extern double Clock_resolution(Clock* me); // ns
+extern double Clock_overhead(Clock* me); // ns
+extern void Clock_printInfo();
+
+#endif // _CLOCK_H
@@ -12,6 +12,7 @@
 #include "som/Dictionary.h"
 #include <stdlib.h>
 #include <assert.h>
+#include "AllocStats.h"
 
 typedef struct Sym Sym;
 typedef struct Strength Strength;
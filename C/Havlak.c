@@ -43,6 +43,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
+#include "AllocStats.h"
 
 typedef struct BasicBlock BasicBlock;
 typedef struct ControlFlowGraph ControlFlowGraph;
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
+#include "AllocStats.h"
 
 typedef struct JsonObject JsonObject;
 typedef struct JsonArray JsonArray;
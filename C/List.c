@@ -24,6 +24,7 @@
 #include "List.h"
 #include "Object.h"
 #include <stdlib.h>
+#include "AllocStats.h"
 
 // NOTE:
 // with refcount: 77us + no leaks
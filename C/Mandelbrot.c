@@ -46,6 +46,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include "AllocStats.h"
 
 static bool verifyResult2(int result, int innerIterations)
 {
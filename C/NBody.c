@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include "AllocStats.h"
 
 #define PI  3.141592653589793
 #define SOLAR_MASS (4 * PI * PI)
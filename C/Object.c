@@ -21,6 +21,7 @@
 
 #include "Object.h"
 #include <stdlib.h>
+#include "AllocStats.h"
 
 void Object_init(Object* me, void (*deinit)(Object*))
 {
@@ -23,6 +23,7 @@
 
 #include "Permute.h"
 #include <stdlib.h>
+#include "AllocStats.h"
 
 typedef struct Permute {
   Benchmark base;
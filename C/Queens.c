@@ -24,6 +24,7 @@
 #include "Queens.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include "AllocStats.h"
 
 typedef struct Queens {
     Benchmark base;
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <memory.h>
+#include "AllocStats.h"
 
 enum Color {
     RED, BLACK
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <assert.h>
+#include "AllocStats.h"
 
 typedef struct Packet Packet;
 typedef struct TaskControlBlock TaskControlBlock;
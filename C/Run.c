@@ -22,7 +22,7 @@
  */
 
 #include "Run.h"
-#include <time.h>
+#include "Clock.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,60 +40,10 @@
 #include "CD.h"
 #include "Havlak.h"
 #include "DeltaBlue.h"
+#include "AllocStats.h"
 
 jmp_buf Run_catch;
 
-#if defined __ECS_C__ || defined __ECS2_C__
-#include <time.h>
-
-typedef struct timeval {
-    long tv_sec;
-    long tv_usec;
-} timeval;
-
-int gettimeofday(struct timeval * tp, struct timezone * tzp)
-{
-    struct timespec ts;
-    timespec_get(&ts,0);
-    tp->tv_sec = ts.tv_sec;
-    tp->tv_usec = ts.tv_nsec / 1000;
-}
-
-#elif defined(_WIN32) && !defined(__GNUC__)
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
-
-// Source: https://stackoverflow.com/questions/10905892/equivalent-of-gettimeday-for-windows/26085827
-
-// MSVC defines this in winsock2.h!?
-typedef struct timeval {
-    long tv_sec;
-    long tv_usec;
-} timeval;
-
-int gettimeofday(struct timeval * tp, struct timezone * tzp)
-{
-    // Note: some broken versions only have 8 trailing zero's, the correct epoch has 9 trailing zero's
-    // This magic number is the number of 100 nanosecond intervals since January 1, 1601 (UTC)
-    // until 00:00:00 January 1, 1970
-    static const uint64_t EPOCH = ((uint64_t) 116444736000000000ULL);
-
-    SYSTEMTIME  system_time;
-    FILETIME    file_time;
-    uint64_t    time;
-
-    GetSystemTime( &system_time );
-    SystemTimeToFileTime( &system_time, &file_time );
-    time =  ((uint64_t)file_time.dwLowDateTime )      ;
-    time += ((uint64_t)file_time.dwHighDateTime) << 32;
-
-    tp->tv_sec  = (long) ((time - EPOCH) / 10000000L);
-    tp->tv_usec = (long) (system_time.wMilliseconds * 1000);
-    return 0;
-}
-#else
-#include <sys/time.h>
-#endif
 
 
 Benchmark *Run_getSuiteFromName(const char* name)
@@ -134,6 +84,7 @@ void Run_init(Run* me, const char* name)
     me->numIterations = 1;
     me->innerIterations = 1;
     me->total = 0;
+    memset(&me->allocs, 0, sizeof(me->allocs));
     me->name = name;
     me->benchmarkSuite = Run_getSuiteFromName(name);
 }
@@ -147,11 +98,11 @@ void Run_deinit(Run* me)
     }
 }
 
-static void printResult(Run* me, long runTime)
+static void printResult(Run* me, double runTime)
 {
 #if 0
     // Checkstyle: stop
-    printf( "%s: iterations=1 runtime: %d us\n", me->name, runTime );
+    printf( "%s: iterations=1 runtime: %.3f us\n", me->name, runTime );
     // Checkstyle: resume
 #endif
 
@@ -161,15 +112,16 @@ void Run_printTotal(Run* me)
 {
 #if 0
     // Checkstyle: stop
-    printf("Total Runtime: %d us\n", total );
+    printf("Total Runtime: %.3f us\n", me->total );
     // Checkstyle: resume
 #endif
 }
 
 static void measure(Run* me, Benchmark *bench)
 {
-    struct timeval start, end;
-    gettimeofday(&start, 0);
+    Clock* clock = Clock_current();
+    const AllocStats allocs = AllocStats_begin();
+    const Ticks start = clock->start();
     bool (*innerBenchmarkLoop)(Benchmark*,int innerIterations) = Benchmark_innerBenchmarkLoop;
     if( bench->innerBenchmarkLoop )
         innerBenchmarkLoop = bench->innerBenchmarkLoop;
@@ -177,10 +129,19 @@ static void measure(Run* me, Benchmark *bench)
         printf("Benchmark failed with incorrect result\n");
         return;
     }
-    gettimeofday(&end, 0);
-    const long seconds = end.tv_sec - start.tv_sec;
-    const long microseconds = end.tv_usec - start.tv_usec;
-    const long runTime = seconds*1000000 + microseconds; // us
+    const Ticks end = clock->stop();
+    const double runTime = Clock_toMicroseconds(clock, end - start); // us
+    if( AllocStats_enabled() )
+    {
+        const AllocStats a = AllocStats_end(&allocs);
+        me->allocs.allocations += a.allocations;
+        me->allocs.deallocations += a.deallocations;
+        me->allocs.bytes += a.bytes;
+        if( a.peak > me->allocs.peak )
+            me->allocs.peak = a.peak;
+        for( int i = 0; i < ALLOCSTATS_SIZE_CLASSES; i++ )
+            me->allocs.histogram[i] += a.histogram[i];
+    }
 
     printResult(me, runTime);
 
@@ -197,8 +158,27 @@ static void doRuns(Run* me, Benchmark *bench)
 static void reportBenchmark(Run* me)
 {
     // Checkstyle: stop
-    printf("%s: iterations=%d average: %ld us total: %ld us\n",
+    printf("%s: iterations=%d average: %.3f us total: %.3f us\n",
             me->name, me->numIterations, (me->total / me->numIterations), me->total);
+    if( AllocStats_enabled() )
+    {
+        const AllocStats* a = &me->allocs;
+        printf("%s: allocations per iteration: %.1f bytes: %.1f peak live: %llu deallocations: %.1f rate: %.0f/s\n",
+               me->name, (double)a->allocations / me->numIterations, (double)a->bytes / me->numIterations,
+               a->peak, (double)a->deallocations / me->numIterations,
+               me->total > 0 ? a->allocations * 1.0e6 / me->total : 0.0);
+        printf("%s: size classes (bytes, count)", me->name);
+        for( int i = 0; i < ALLOCSTATS_SIZE_CLASSES; i++ )
+        {
+            if( a->histogram[i] == 0 )
+                continue;
+            if( i == ALLOCSTATS_SIZE_CLASSES - 1 )
+                printf(" >%llu: %llu", AllocStats_sizeClassLimit(i - 1), a->histogram[i]);
+            else
+                printf(" <=%llu: %llu", AllocStats_sizeClassLimit(i), a->histogram[i]);
+        }
+        printf("\n");
+    }
     fflush(stdout);
     // Checkstyle: resume
 
@@ -25,6 +25,7 @@
  */
 
 #include "Benchmark.h"
+#include "AllocStats.h"
 #include <setjmp.h>
 
 typedef struct Run {
@@ -32,7 +33,8 @@ typedef struct Run {
     Benchmark* benchmarkSuite;
     int numIterations;
     int innerIterations;
-    long total;
+    double total; // us
+    AllocStats allocs; // sum over all iterations, peak is the maximum; if AllocStats_enabled()
 } Run;
 
 extern void Run_init(Run* me, const char* name);
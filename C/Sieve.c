@@ -24,6 +24,7 @@
 #include "Sieve.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include "AllocStats.h"
 
 static int sieve(bool *flags, int size)
 {
@@ -25,6 +25,7 @@
 #include "som/Random.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include "AllocStats.h"
 
 typedef struct Storage {
   Benchmark base;
@@ -25,6 +25,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <assert.h>
+#include "AllocStats.h"
 
 typedef struct TowersDisk TowersDisk;
 
@@ -20,11 +20,13 @@
  */
 
 #include "Run.h"
+#include "Clock.h"
 #include <assert.h>
 #include <stdio.h>
 #include "RedBlackTree.h"
 #include "som/Dictionary.h"
 #include <stdarg.h>
+#include <stdlib.h>
 
 static int compare(const Bytes l, const Bytes r)
 {
@@ -179,6 +181,15 @@ static void runOnce()
 
 int main(int argc, char *argv[])
 {
+    const char* clock = getenv("AWFY_CLOCK");
+    if( clock && !Clock_select(clock) )
+    {
+        printf("unknown or unsupported clock %s, available: %s\n", clock, Clock_available());
+        return 1;
+    }
+    Clock_printInfo();
+    printf("\n");
+
     runAll();
     //runOnce();
 
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <memory.h>
 #include <assert.h>
+#include "../AllocStats.h"
 
 typedef struct Entry Entry;
 
@@ -25,6 +25,7 @@
 #include "Vector.h"
 #include <stdlib.h>
 #include <memory.h>
+#include "../AllocStats.h"
 
 struct Set {
     Vector* items;
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <memory.h>
+#include "../AllocStats.h"
 
 struct Vector {
     int firstIdx;
@@ -0,0 +1,202 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "AllocStats.h"
+#include "Thread.h"
+#include "Statistics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+// per thread, so that the throughput mode neither races nor mixes the counts of the instances
+static THREAD_LOCAL AllocStats::Counters s_counters;
+
+AllocStats::Sample::Sample():allocations(0),deallocations(0),bytes(0),peak(0)
+{
+    memset(histogram, 0, sizeof(histogram));
+}
+
+unsigned long long AllocStats::sizeClassLimit(int sizeClass)
+{
+    return 16ULL << sizeClass;
+}
+
+int AllocStats::sizeClass(unsigned long long size)
+{
+    int c = 0;
+    while( c < SIZE_CLASSES - 1 && size > sizeClassLimit(c) )
+        c++;
+    return c;
+}
+
+AllocStats::Sample AllocStats::summarize(const std::vector<Sample>& samples, int from)
+{
+    Sample res;
+    if( from < 0 || from >= (int)samples.size() )
+        return res;
+    std::vector<double> allocations, deallocations, bytes, peak;
+    for( int i = from; i < (int)samples.size(); i++ )
+    {
+        const Sample& s = samples[i];
+        allocations.push_back(s.allocations);
+        deallocations.push_back(s.deallocations);
+        bytes.push_back(s.bytes);
+        peak.push_back(s.peak);
+        for( int c = 0; c < SIZE_CLASSES; c++ )
+            res.histogram[c] += s.histogram[c];
+    }
+    res.allocations = Statistics::median(allocations);
+    res.deallocations = Statistics::median(deallocations);
+    res.bytes = Statistics::median(bytes);
+    res.peak = Statistics::median(peak);
+    return res;
+}
+
+#ifdef AWFY_ALLOC_STATS
+
+bool AllocStats::enabled()
+{
+    return true;
+}
+
+AllocStats::Counters AllocStats::begin()
+{
+    s_counters.peak = s_counters.live;
+    return s_counters;
+}
+
+AllocStats::Sample AllocStats::end(const Counters& begin)
+{
+    const Counters& now = s_counters;
+    Sample s;
+    s.allocations = now.allocations - begin.allocations;
+    s.deallocations = now.deallocations - begin.deallocations;
+    s.bytes = now.bytes - begin.bytes;
+    s.peak = now.peak > begin.live ? now.peak - begin.live : 0;
+    for( int i = 0; i < SIZE_CLASSES; i++ )
+        s.histogram[i] = now.histogram[i] - begin.histogram[i];
+    return s;
+}
+
+#if __cplusplus >= 201103L
+#define THROW_BAD_ALLOC
+#define NO_THROW noexcept
+#else
+#define THROW_BAD_ALLOC throw(std::bad_alloc)
+#define NO_THROW throw()
+#endif
+
+// 16 bytes keep the alignment malloc guarantees on 64 bit platforms
+static const size_t HEADER = 16;
+
+static void* allocate(size_t size)
+{
+    char* p = (char*)malloc(size + HEADER);
+    if( p == 0 )
+        return 0;
+    *(size_t*)p = size;
+    AllocStats::Counters& c = s_counters;
+    c.allocations++;
+    c.bytes += size;
+    c.live += size;
+    if( c.live > c.peak )
+        c.peak = c.live;
+    c.histogram[AllocStats::sizeClass(size)]++;
+    return p + HEADER;
+}
+
+static void deallocate(void* ptr)
+{
+    if( ptr == 0 )
+        return;
+    char* p = (char*)ptr - HEADER;
+    AllocStats::Counters& c = s_counters;
+    c.deallocations++;
+    const size_t size = *(size_t*)p;
+    // blocks may be deleted by another thread than the allocating one
+    c.live = c.live > size ? c.live - size : 0;
+    free(p);
+}
+
+void* operator new(size_t size) THROW_BAD_ALLOC
+{
+    void* p = allocate(size);
+    if( p == 0 )
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) THROW_BAD_ALLOC
+{
+    void* p = allocate(size);
+    if( p == 0 )
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) NO_THROW
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) NO_THROW
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) NO_THROW
+{
+    deallocate(p);
+}
+
+void operator delete[](void* p) NO_THROW
+{
+    deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) NO_THROW
+{
+    deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) NO_THROW
+{
+    deallocate(p);
+}
+
+#else
+
+bool AllocStats::enabled()
+{
+    return false;
+}
+
+AllocStats::Counters AllocStats::begin()
+{
+    return s_counters;
+}
+
+AllocStats::Sample AllocStats::end(const Counters&)
+{
+    return Sample();
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef _ALLOCSTATS_H
+#define _ALLOCSTATS_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <vector>
+
+// Compile switch for the allocation profiling build; when defined, AllocStats.cpp replaces
+// the global operator new and delete by versions which count each allocation of the
+// calling thread. Adds a 16 byte size header to each block, so the timing is affected.
+// #define AWFY_ALLOC_STATS
+
+class AllocStats {
+public:
+    // size classes 16, 32, .. 64K bytes (upper bounds inclusive), the last one collects the rest
+    enum { SIZE_CLASSES = 14 };
+
+    struct Counters {
+        unsigned long long allocations;
+        unsigned long long deallocations;
+        unsigned long long bytes;       // requested bytes
+        unsigned long long live;        // bytes allocated but not yet deleted
+        unsigned long long peak;        // highest live since the last begin()
+        unsigned long long histogram[SIZE_CLASSES];
+    };
+
+    // what happened between begin() and end(); peak is relative to the live bytes at begin()
+    struct Sample {
+        unsigned long long allocations;
+        unsigned long long deallocations;
+        unsigned long long bytes;
+        unsigned long long peak;
+        unsigned long long histogram[SIZE_CLASSES];
+        Sample();
+    };
+
+    // medians per sample of the samples from index 'from' on; the histogram is their sum
+    static Sample summarize(const std::vector<Sample>& samples, int from);
+
+    static bool enabled();
+    static Counters begin();
+    static Sample end(const Counters& begin);
+
+    static unsigned long long sizeClassLimit(int sizeClass);
+    static int sizeClass(unsigned long long size);
+};
+
+#endif // _ALLOCSTATS_H
@@ -0,0 +1,342 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Allocator.h"
+#include "Thread.h"
+#include <vector>
+#include <string.h>
+
+// The backends get their memory from the global operator new, so that the allocation
+// profiling build (see AllocStats.h) counts what they request from the system.
+
+class SystemAllocator : public Allocator {
+public:
+    const char* name() const { return "system"; }
+    bool isThreadSafe() const { return true; }
+protected:
+    Header* alloc(size_t size) {
+        return (Header*)::operator new(size);
+    }
+    void release(Header* h) {
+        ::operator delete(h);
+    }
+};
+
+// Bump pointer allocation from large chunks. The memory allocated during a sample is
+// reclaimed at the end of the sample if all of it has been deallocated (blocks are
+// tagged with the sample number), and all memory is reclaimed whenever nothing is live.
+// A sample of which a block survives is never reclaimed, so the arena grows with each
+// sample unless the benchmark releases its result in Benchmark::endSample.
+class ArenaAllocator : public Allocator {
+    enum { CHUNK_SIZE = 256 * 1024 };
+    struct Chunk {
+        char* mem;
+        size_t size;
+    };
+    std::vector<Chunk> chunks;
+    int chunk;          // index of the chunk in use
+    size_t offset;      // first free byte in the chunk in use
+    int markChunk;
+    size_t markOffset;
+    unsigned int sample;
+    int live;           // number of live blocks
+    int liveOfSample;   // number of live blocks allocated during the current sample
+public:
+    ArenaAllocator():chunk(-1),offset(0),markChunk(-1),markOffset(0),sample(0),live(0),liveOfSample(0) {}
+    ~ArenaAllocator() {
+        for( int i = 0; i < (int)chunks.size(); i++ )
+            ::operator delete(chunks[i].mem);
+    }
+    const char* name() const { return "arena"; }
+    void beginSample() {
+        sample++;
+        liveOfSample = 0;
+        markChunk = chunk;
+        markOffset = offset;
+    }
+    void endSample() {
+        if( liveOfSample == 0 )
+            rewind(markChunk, markOffset);
+    }
+protected:
+    Header* alloc(size_t size) {
+        size = (size + 15) & ~(size_t)15;
+        if( chunk < 0 || offset + size > chunks[chunk].size )
+            nextChunk(size);
+        Header* h = (Header*)(chunks[chunk].mem + offset);
+        offset += size;
+        h->tag = sample;
+        live++;
+        liveOfSample++;
+        return h;
+    }
+    void release(Header* h) {
+        live--;
+        if( h->tag == sample )
+            liveOfSample--;
+        if( live == 0 )
+        {
+            rewind(-1, 0);
+            markChunk = -1;
+            markOffset = 0;
+            liveOfSample = 0;
+        }
+    }
+    bool extend(Header* h, size_t size) {
+        // only the last block of the chunk in use can grow, and only if it was allocated
+        // during the current sample; an older block would grow beyond the mark, and the
+        // grown part would be overwritten after the rewind in endSample
+        const size_t old = (h->size + 15) & ~(size_t)15;
+        size = (size + 15) & ~(size_t)15;
+        if( chunk < 0 || h->tag != sample || (char*)h + old != chunks[chunk].mem + offset ||
+                offset - old + size > chunks[chunk].size )
+            return false;
+        offset = offset - old + size;
+        return true;
+    }
+private:
+    void rewind(int c, size_t o) {
+        chunk = c;
+        offset = o;
+    }
+    void nextChunk(size_t size) {
+        // reuse the following chunk if big enough, otherwise insert a new one
+        chunk++;
+        offset = 0;
+        if( chunk < (int)chunks.size() && chunks[chunk].size >= size )
+            return;
+        Chunk c;
+        c.size = size > (size_t)CHUNK_SIZE ? size : (size_t)CHUNK_SIZE;
+        c.mem = (char*)::operator new(c.size);
+        chunks.insert(chunks.begin() + chunk, c);
+    }
+};
+
+// Segregated free lists for the size classes 16, 32, .. MAX_SMALL bytes, carved from
+// slabs; larger blocks come from the system.
+class PoolAllocator : public Allocator {
+public:
+    enum { GRANULE = 16, MAX_SMALL = 1024, CLASSES = MAX_SMALL / GRANULE, SLAB_SIZE = 64 * 1024 };
+    PoolAllocator() {
+        memset(freeLists, 0, sizeof(freeLists));
+    }
+    ~PoolAllocator() {
+        for( int i = 0; i < (int)slabs.size(); i++ )
+            ::operator delete(slabs[i]);
+    }
+    const char* name() const { return "pool"; }
+
+    static int sizeClass(size_t size) { return (size + GRANULE - 1) / GRANULE - 1; }
+
+    void* pop(int c) {
+        if( freeLists[c] == 0 )
+            refill(c);
+        FreeBlock* b = freeLists[c];
+        freeLists[c] = b->next;
+        return b;
+    }
+    void push(int c, void* block) {
+        FreeBlock* b = (FreeBlock*)block;
+        b->next = freeLists[c];
+        freeLists[c] = b;
+    }
+protected:
+    Header* alloc(size_t size) {
+        if( size > MAX_SMALL )
+            return (Header*)::operator new(size);
+        return (Header*)pop(sizeClass(size));
+    }
+    void release(Header* h) {
+        if( h->size > MAX_SMALL )
+            ::operator delete(h);
+        else
+            push(sizeClass(h->size), h);
+    }
+    bool extend(Header* h, size_t size) {
+        return size <= MAX_SMALL && sizeClass(size) == sizeClass(h->size);
+    }
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    FreeBlock* freeLists[CLASSES];
+    std::vector<char*> slabs;
+
+    void refill(int c) {
+        const size_t size = (c + 1) * GRANULE;
+        char* slab = (char*)::operator new(SLAB_SIZE);
+        slabs.push_back(slab);
+        for( size_t off = 0; off + size <= SLAB_SIZE; off += size )
+            push(c, slab + off);
+    }
+};
+
+// Per thread caches of free blocks in front of a shared, locked pool; blocks move
+// between a cache and the pool in batches.
+class ThreadCacheAllocator : public Allocator {
+    enum { BATCH = 32, CACHE_LIMIT = 2 * BATCH };
+    struct Cache {
+        unsigned int id; // of the allocator the cached blocks belong to
+        void* heads[PoolAllocator::CLASSES];
+        int counts[PoolAllocator::CLASSES];
+    };
+    static THREAD_LOCAL Cache cache;
+    static unsigned int lastId;
+    PoolAllocator central;
+    Mutex lock;
+    unsigned int id;
+public:
+    ThreadCacheAllocator() {
+        id = ++lastId; // allocators are created by the main thread
+    }
+    ~ThreadCacheAllocator() {
+        // the caches of other threads are dropped when they see a different id
+        if( cache.id == id )
+            cache.id = 0;
+    }
+    const char* name() const { return "tcache"; }
+    bool isThreadSafe() const { return true; }
+protected:
+    Header* alloc(size_t size) {
+        if( size > PoolAllocator::MAX_SMALL )
+            return (Header*)::operator new(size);
+        Cache& tc = myCache();
+        const int c = PoolAllocator::sizeClass(size);
+        if( tc.counts[c] == 0 )
+        {
+            lock.lock();
+            for( int i = 0; i < BATCH; i++ )
+                put(tc, c, central.pop(c));
+            lock.unlock();
+        }
+        void* b = tc.heads[c];
+        tc.heads[c] = *(void**)b;
+        tc.counts[c]--;
+        return (Header*)b;
+    }
+    void release(Header* h) {
+        if( h->size > PoolAllocator::MAX_SMALL )
+        {
+            ::operator delete(h);
+            return;
+        }
+        Cache& tc = myCache();
+        const int c = PoolAllocator::sizeClass(h->size);
+        put(tc, c, h);
+        if( tc.counts[c] > CACHE_LIMIT )
+        {
+            lock.lock();
+            for( int i = 0; i < BATCH; i++ )
+            {
+                void* b = tc.heads[c];
+                tc.heads[c] = *(void**)b;
+                central.push(c, b);
+            }
+            tc.counts[c] -= BATCH;
+            lock.unlock();
+        }
+    }
+    bool extend(Header* h, size_t size) {
+        return size <= PoolAllocator::MAX_SMALL && PoolAllocator::sizeClass(size) == PoolAllocator::sizeClass(h->size);
+    }
+private:
+    Cache& myCache() {
+        Cache& tc = cache;
+        if( tc.id != id )
+        {
+            memset(&tc, 0, sizeof(tc));
+            tc.id = id;
+        }
+        return tc;
+    }
+    static void put(Cache& tc, int c, void* b) {
+        *(void**)b = tc.heads[c];
+        tc.heads[c] = b;
+        tc.counts[c]++;
+    }
+};
+
+THREAD_LOCAL ThreadCacheAllocator::Cache ThreadCacheAllocator::cache;
+unsigned int ThreadCacheAllocator::lastId = 0;
+
+static SystemAllocator s_system;
+static THREAD_LOCAL Allocator* s_current = 0;
+
+void* Allocator::allocate(size_t size)
+{
+    Allocator* a = current();
+    Header* h = a->alloc(size + HEADER_SIZE);
+    h->owner = a;
+    h->size = size + HEADER_SIZE;
+    return (char*)h + HEADER_SIZE;
+}
+
+void Allocator::deallocate(void* ptr)
+{
+    if( ptr == 0 )
+        return;
+    Header* h = (Header*)((char*)ptr - HEADER_SIZE);
+    h->owner->release(h);
+}
+
+void* Allocator::reallocate(void* ptr, size_t size)
+{
+    if( ptr == 0 )
+        return allocate(size);
+    Header* h = (Header*)((char*)ptr - HEADER_SIZE);
+    if( h->owner->extend(h, size + HEADER_SIZE) )
+    {
+        h->size = size + HEADER_SIZE;
+        return ptr;
+    }
+    void* res = allocate(size);
+    memcpy(res, ptr, h->size - HEADER_SIZE < size ? h->size - HEADER_SIZE : size);
+    deallocate(ptr);
+    return res;
+}
+
+Allocator* Allocator::create(const std::string& name)
+{
+    if( name == "system" || name.empty() )
+        return new SystemAllocator();
+    if( name == "arena" )
+        return new ArenaAllocator();
+    if( name == "pool" )
+        return new PoolAllocator();
+    if( name == "tcache" )
+        return new ThreadCacheAllocator();
+    return 0;
+}
+
+const char* Allocator::available()
+{
+    return "system, arena, pool, tcache";
+}
+
+Allocator* Allocator::current()
+{
+    return s_current ? s_current : &s_system;
+}
+
+void Allocator::setCurrent(Allocator* a)
+{
+    s_current = a;
+}
@@ -0,0 +1,96 @@
+#ifndef _AWFY_ALLOCATOR_H
+#define _AWFY_ALLOCATOR_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <string>
+#include <new>
+
+// Memory of Object, the som containers and the RedBlackTree nodes is allocated through
+// the current Allocator of the thread, so that allocation strategies can be compared
+// within the same binary. Each block starts with a 16 byte header which refers to the
+// allocator which owns the block, so blocks can be deallocated after the current
+// allocator was changed.
+class Allocator {
+public:
+    virtual ~Allocator() {}
+    virtual const char* name() const = 0;
+    // true if blocks may be allocated and deallocated by different threads concurrently
+    virtual bool isThreadSafe() const { return false; }
+    // called by Run around each sample, outside of the timed section
+    virtual void beginSample() {}
+    virtual void endSample() {}
+
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr);
+    // Resizes a block returned by allocate() whose contents may be moved with memcpy;
+    // the owner may grow it in place, otherwise it is moved to a block of the current
+    // allocator. ptr may be 0.
+    static void* reallocate(void* ptr, size_t size);
+
+    template<class T>
+    static T* newArray(int n) {
+        if( n <= 0 )
+            return 0;
+        T* a = (T*)allocate(n * sizeof(T));
+        for( int i = 0; i < n; i++ )
+            new(a + i) T();
+        return a;
+    }
+
+    template<class T>
+    static void deleteArray(T* a, int n) {
+        if( a == 0 )
+            return;
+        for( int i = n - 1; i >= 0; i-- )
+            a[i].~T();
+        deallocate(a);
+    }
+
+    // system, arena, pool or tcache; returns 0 if the name is unknown
+    static Allocator* create(const std::string& name);
+    static const char* available();
+    // the allocator of the calling thread; the system allocator unless set
+    static Allocator* current();
+    static void setCurrent(Allocator*);
+
+    struct Header {
+        Allocator* owner;
+        unsigned int size; // including the header
+        unsigned int tag;  // for use by the owner
+    };
+    enum { HEADER_SIZE = 16 };
+protected:
+    // returns a block of at least size bytes and sets header->tag if needed
+    virtual Header* alloc(size_t size) = 0;
+    virtual void release(Header*) = 0;
+    // grows the block in place to at least size bytes (including the header) if possible
+    virtual bool extend(Header*, size_t /*size*/) { return false; }
+};
+
+// Used inside a class declaration to allocate its instances with the current allocator.
+#define ALLOCATED_BY_CURRENT \
+    static void* operator new(size_t size) { return Allocator::allocate(size); } \
+    static void operator delete(void* ptr) { Allocator::deallocate(ptr); }
+
+#endif // _AWFY_ALLOCATOR_H
@@ -0,0 +1,622 @@
+#ifndef _BTREE_H
+#define _BTREE_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <som/Interfaces.h>
+#include <som/Vector.h>
+#include "Allocator.h"
+
+// Benchmark variant switch: if defined, CD uses BTree instead of RedBlackTree for its
+// aircraft state and voxel maps
+// #define CD_USE_BTREE
+
+// B+ tree with the interface of RedBlackTree. The keys of a node are stored contiguously
+// and the nodes are sized to a few cache lines, so a lookup touches a handful of nodes
+// instead of one node per level of a binary tree. All entries are in the leaves, which
+// are linked for in-order iteration. K and V must be default constructible.
+template <class K, class V, class C>
+class BTree {
+    enum {
+        NODE_BYTES = 256,
+        LEAF_SLOTS = NODE_BYTES / sizeof(K) < 4 ? 4 :
+                     NODE_BYTES / sizeof(K) > 64 ? 64 : NODE_BYTES / sizeof(K),
+        INNER_SLOTS = NODE_BYTES / (sizeof(K) + sizeof(void*)) < 4 ? 4 :
+                      NODE_BYTES / (sizeof(K) + sizeof(void*)) > 64 ? 64 :
+                      NODE_BYTES / (sizeof(K) + sizeof(void*)),
+        // fill of all nodes but the root; that's what remains of a split
+        MIN_LEAF = LEAF_SLOTS / 2,
+        MIN_INNER = (INNER_SLOTS - 1) / 2
+    };
+
+    struct Node {
+        int count; // number of keys
+        bool leaf;
+        Node(bool l):count(0),leaf(l) {}
+    };
+
+    struct Leaf : public Node {
+        ALLOCATED_BY_CURRENT
+        K keys[LEAF_SLOTS];
+        V values[LEAF_SLOTS];
+        Leaf* prev;
+        Leaf* next;
+        Leaf():Node(true),prev(0),next(0) {}
+    };
+
+    // children[i] holds the keys between keys[i-1] (inclusive) and keys[i]
+    struct Inner : public Node {
+        ALLOCATED_BY_CURRENT
+        K keys[INNER_SLOTS];
+        Node* children[INNER_SLOTS + 1];
+        Inner():Node(false) {}
+    };
+
+    Node* root;
+    Leaf* first;
+    Leaf* last;
+    V oldValue;
+
+    BTree(const BTree&);
+    BTree& operator=(const BTree&);
+
+public:
+    BTree():root(0),first(0),last(0) {
+    }
+
+    ~BTree()
+    {
+        removeAll();
+    }
+
+    void removeAll() {
+        if (root != 0) {
+            destroy(root);
+        }
+        root = 0;
+        first = last = 0;
+    }
+
+    // returns the previous value if key was already present, 0 otherwise
+    V* put(const K& key, const V& value) {
+        if (root == 0) {
+            root = first = last = new Leaf();
+        }
+        K splitKey;
+        Node* splitNode = 0;
+        const bool isNewEntry = insert(root, key, value, splitKey, splitNode);
+        if (splitNode != 0) {
+            Inner* r = new Inner();
+            r->keys[0] = splitKey;
+            r->children[0] = root;
+            r->children[1] = splitNode;
+            r->count = 1;
+            root = r;
+        }
+        return isNewEntry ? 0 : &oldValue;
+    }
+
+    V remove(const K& key) {
+        V res;
+        if (root == 0 || !erase(root, key, res)) {
+            return V();
+        }
+        if (root->count == 0) {
+            if (root->leaf) {
+                delete (Leaf*)root;
+                root = 0;
+                first = last = 0;
+            } else {
+                Inner* r = (Inner*)root;
+                root = r->children[0];
+                delete r;
+            }
+        }
+        return res;
+    }
+
+    V* get(const K& key) {
+        if (root == 0) {
+            return 0;
+        }
+        Leaf* leaf = findLeaf(key);
+        const int i = lowerIndex(leaf->keys, leaf->count, key);
+        C compareTo;
+        if (i < leaf->count && compareTo(key, leaf->keys[i]) == 0) {
+            return &leaf->values[i];
+        }
+        return 0;
+    }
+
+    // refers to the key and value in the tree, so visiting an entry copies neither
+    template <class KK, class VV>
+    class Entry {
+    public:
+        const KK& key;
+        const VV& value;
+        Entry(const KK& key, const VV& value):key(key),value(value) {}
+    };
+
+    void forEach(som::ForEachInterface<Entry<K, V> >& fn) {
+        for (Leaf* leaf = first; leaf != 0; leaf = leaf->next) {
+            for (int i = 0; i < leaf->count; i++) {
+                fn.apply(Entry<K, V>(leaf->keys[i], leaf->values[i]));
+            }
+        }
+    }
+
+    template<class F>
+    typename som::EnableIf<!som::IsDerived<F, som::ForEachInterface<Entry<K, V> > >::value>::Type forEach(F fn) {
+        for (Leaf* leaf = first; leaf != 0; leaf = leaf->next) {
+            for (int i = 0; i < leaf->count; i++) {
+                fn(Entry<K, V>(leaf->keys[i], leaf->values[i]));
+            }
+        }
+    }
+
+    // In-order bidirectional iterator; end() is one past the largest key. Any put or
+    // remove invalidates the iterators.
+    class iterator {
+        friend class BTree;
+        BTree* tree;
+        Leaf* leaf;
+        int idx;
+        iterator(BTree* t, Leaf* l, int i):tree(t),leaf(l),idx(i) {}
+    public:
+        iterator():tree(0),leaf(0),idx(0) {}
+
+        const K& key() const { return leaf->keys[idx]; }
+        V& value() const { return leaf->values[idx]; }
+        Entry<K, V> operator*() const { return Entry<K, V>(leaf->keys[idx], leaf->values[idx]); }
+
+        iterator& operator++() {
+            if (++idx == leaf->count) {
+                leaf = leaf->next;
+                idx = 0;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        // decrementing end() yields the largest key
+        iterator& operator--() {
+            if (leaf == 0) {
+                leaf = tree->last;
+                idx = leaf == 0 ? 0 : leaf->count - 1;
+            } else if (idx > 0) {
+                idx--;
+            } else {
+                leaf = leaf->prev;
+                idx = leaf == 0 ? 0 : leaf->count - 1;
+            }
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const iterator& rhs) const { return leaf == rhs.leaf && idx == rhs.idx; }
+        bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    iterator begin() {
+        return iterator(this, first, 0);
+    }
+
+    iterator end() {
+        return iterator(this, 0, 0);
+    }
+
+    // the first entry whose key is not less than key
+    iterator lowerBound(const K& key) {
+        if (root == 0) {
+            return end();
+        }
+        Leaf* leaf = findLeaf(key);
+        return position(leaf, lowerIndex(leaf->keys, leaf->count, key));
+    }
+
+    // the first entry whose key is greater than key
+    iterator upperBound(const K& key) {
+        if (root == 0) {
+            return end();
+        }
+        Leaf* leaf = findLeaf(key);
+        return position(leaf, upperIndex(leaf->keys, leaf->count, key));
+    }
+
+    // Replaces the contents by the given entries in linear time; the keys must be in
+    // strictly ascending order. The entries are spread evenly over the fewest leaves
+    // that hold them, and the inner levels are built bottom up the same way.
+    void build(const som::Vector<K>& keys, const som::Vector<V>& values) {
+        const int n = keys.size();
+        if (values.size() != n) {
+            throw "size mismatch";
+        }
+        C compareTo;
+        for (int i = 1; i < n; i++) {
+            if (compareTo(keys.at(i - 1), keys.at(i)) >= 0) {
+                throw "keys not ascending";
+            }
+        }
+        removeAll();
+        if (n == 0) {
+            return;
+        }
+
+        som::Vector<Node*> level;
+        som::Vector<K> lowest; // the smallest key below each node of level
+        const int leaves = (n + LEAF_SLOTS - 1) / LEAF_SLOTS;
+        int k = 0;
+        for (int i = 0; i < leaves; i++) {
+            Leaf* leaf = new Leaf();
+            leaf->count = n / leaves + (i < n % leaves ? 1 : 0);
+            for (int j = 0; j < leaf->count; j++, k++) {
+                leaf->keys[j] = keys.at(k);
+                leaf->values[j] = values.at(k);
+            }
+            leaf->prev = last;
+            if (last != 0) {
+                last->next = leaf;
+            } else {
+                first = leaf;
+            }
+            last = leaf;
+            level.append(leaf);
+            lowest.append(leaf->keys[0]);
+        }
+
+        while (level.size() > 1) {
+            som::Vector<Node*> parents;
+            som::Vector<K> parentLowest;
+            const int m = level.size();
+            const int inners = (m + INNER_SLOTS) / (INNER_SLOTS + 1);
+            int c = 0;
+            for (int i = 0; i < inners; i++) {
+                Inner* inner = new Inner();
+                const int children = m / inners + (i < m % inners ? 1 : 0);
+                parentLowest.append(lowest.at(c));
+                for (int j = 0; j < children; j++, c++) {
+                    inner->children[j] = level.at(c);
+                    if (j > 0) {
+                        inner->keys[j - 1] = lowest.at(c);
+                    }
+                }
+                inner->count = children - 1;
+                parents.append(inner);
+            }
+            level = parents;
+            lowest = parentLowest;
+        }
+        root = level.at(0);
+    }
+
+private:
+    // index of the first key not less than key
+    static int lowerIndex(const K* keys, int count, const K& key) {
+        C compareTo;
+        int lo = 0;
+        int hi = count;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (compareTo(keys[mid], key) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // index of the first key greater than key
+    static int upperIndex(const K* keys, int count, const K& key) {
+        C compareTo;
+        int lo = 0;
+        int hi = count;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (compareTo(key, keys[mid]) < 0) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+    Leaf* findLeaf(const K& key) const {
+        Node* n = root;
+        while (!n->leaf) {
+            Inner* inner = (Inner*)n;
+            n = inner->children[upperIndex(inner->keys, inner->count, key)];
+        }
+        return (Leaf*)n;
+    }
+
+    iterator position(Leaf* leaf, int i) {
+        if (i == leaf->count) {
+            return iterator(this, leaf->next, 0);
+        }
+        return iterator(this, leaf, i);
+    }
+
+    void destroy(Node* n) {
+        if (n->leaf) {
+            delete (Leaf*)n;
+        } else {
+            Inner* inner = (Inner*)n;
+            for (int i = 0; i <= inner->count; i++) {
+                destroy(inner->children[i]);
+            }
+            delete inner;
+        }
+    }
+
+    // moves the entries from..count-1 of leaf by delta slots; the slots left
+    // behind keep moved-from objects
+    static void shiftLeaf(Leaf* leaf, int from, int delta) {
+        if (delta > 0) {
+            for (int i = leaf->count - 1; i >= from; i--) {
+                leaf->keys[i + delta] = SOM_MOVE(leaf->keys[i]);
+                leaf->values[i + delta] = SOM_MOVE(leaf->values[i]);
+            }
+        } else {
+            for (int i = from; i < leaf->count; i++) {
+                leaf->keys[i + delta] = SOM_MOVE(leaf->keys[i]);
+                leaf->values[i + delta] = SOM_MOVE(leaf->values[i]);
+            }
+        }
+    }
+
+    // same for the keys from..count-1 and the children from + 1..count of inner
+    static void shiftInner(Inner* inner, int from, int delta) {
+        if (delta > 0) {
+            for (int i = inner->count - 1; i >= from; i--) {
+                inner->keys[i + delta] = SOM_MOVE(inner->keys[i]);
+                inner->children[i + 1 + delta] = inner->children[i + 1];
+            }
+        } else {
+            for (int i = from; i < inner->count; i++) {
+                inner->keys[i + delta] = SOM_MOVE(inner->keys[i]);
+                inner->children[i + 1 + delta] = inner->children[i + 1];
+            }
+        }
+    }
+
+    // releases what the unused slot i of leaf still holds
+    static void clearSlot(Leaf* leaf, int i) {
+        leaf->keys[i] = K();
+        leaf->values[i] = V();
+    }
+
+    // returns true if key was added; a node which had to be split returns its new right
+    // sibling in splitNode and the smallest key below the sibling in splitKey
+    bool insert(Node* n, const K& key, const V& value, K& splitKey, Node*& splitNode) {
+        C compareTo;
+        if (n->leaf) {
+            Leaf* leaf = (Leaf*)n;
+            int i = lowerIndex(leaf->keys, leaf->count, key);
+            if (i < leaf->count && compareTo(key, leaf->keys[i]) == 0) {
+                oldValue = leaf->values[i];
+                leaf->values[i] = value;
+                return false;
+            }
+            if (leaf->count == LEAF_SLOTS) {
+                Leaf* right = new Leaf();
+                const int half = LEAF_SLOTS / 2;
+                for (int j = half; j < leaf->count; j++) {
+                    right->keys[j - half] = SOM_MOVE(leaf->keys[j]);
+                    right->values[j - half] = SOM_MOVE(leaf->values[j]);
+                    clearSlot(leaf, j);
+                }
+                right->count = leaf->count - half;
+                leaf->count = half;
+                right->next = leaf->next;
+                right->prev = leaf;
+                if (leaf->next != 0) {
+                    leaf->next->prev = right;
+                } else {
+                    last = right;
+                }
+                leaf->next = right;
+                if (i > half) {
+                    leaf = right;
+                    i -= half;
+                }
+                splitNode = right;
+            }
+            shiftLeaf(leaf, i, 1);
+            leaf->keys[i] = key;
+            leaf->values[i] = value;
+            leaf->count++;
+            if (splitNode != 0) {
+                splitKey = ((Leaf*)splitNode)->keys[0];
+            }
+            return true;
+        }
+
+        Inner* inner = (Inner*)n;
+        int i = upperIndex(inner->keys, inner->count, key);
+        K childKey;
+        Node* childNode = 0;
+        const bool isNewEntry = insert(inner->children[i], key, value, childKey, childNode);
+        if (childNode == 0) {
+            return isNewEntry;
+        }
+        if (inner->count == INNER_SLOTS) {
+            Inner* right = new Inner();
+            const int mid = INNER_SLOTS / 2;
+            splitKey = inner->keys[mid];
+            for (int j = mid + 1; j < inner->count; j++) {
+                right->keys[j - mid - 1] = SOM_MOVE(inner->keys[j]);
+            }
+            for (int j = mid + 1; j <= inner->count; j++) {
+                right->children[j - mid - 1] = inner->children[j];
+            }
+            right->count = inner->count - mid - 1;
+            inner->count = mid;
+            if (i > mid) {
+                inner = right;
+                i -= mid + 1;
+            }
+            splitNode = right;
+        }
+        shiftInner(inner, i, 1);
+        inner->keys[i] = childKey;
+        inner->children[i + 1] = childNode;
+        inner->count++;
+        return isNewEntry;
+    }
+
+    // returns true if key was found, with its value in res
+    bool erase(Node* n, const K& key, V& res) {
+        if (n->leaf) {
+            Leaf* leaf = (Leaf*)n;
+            const int i = lowerIndex(leaf->keys, leaf->count, key);
+            C compareTo;
+            if (i == leaf->count || compareTo(key, leaf->keys[i]) != 0) {
+                return false;
+            }
+            res = SOM_MOVE(leaf->values[i]);
+            shiftLeaf(leaf, i + 1, -1);
+            leaf->count--;
+            clearSlot(leaf, leaf->count);
+            return true;
+        }
+        Inner* inner = (Inner*)n;
+        const int i = upperIndex(inner->keys, inner->count, key);
+        if (!erase(inner->children[i], key, res)) {
+            return false;
+        }
+        Node* child = inner->children[i];
+        if (child->count < (child->leaf ? (int)MIN_LEAF : (int)MIN_INNER)) {
+            rebalance(inner, i);
+        }
+        return true;
+    }
+
+    // refills the underfull child i of p from a sibling, or merges it with one
+    void rebalance(Inner* p, int i) {
+        const int min = p->children[i]->leaf ? MIN_LEAF : MIN_INNER;
+        if (i > 0 && p->children[i - 1]->count > min) {
+            borrowFromLeft(p, i);
+        } else if (i < p->count && p->children[i + 1]->count > min) {
+            borrowFromRight(p, i);
+        } else if (i > 0) {
+            merge(p, i - 1);
+        } else {
+            merge(p, i);
+        }
+    }
+
+    void borrowFromLeft(Inner* p, int i) {
+        if (p->children[i]->leaf) {
+            Leaf* left = (Leaf*)p->children[i - 1];
+            Leaf* c = (Leaf*)p->children[i];
+            shiftLeaf(c, 0, 1);
+            left->count--;
+            c->keys[0] = SOM_MOVE(left->keys[left->count]);
+            c->values[0] = SOM_MOVE(left->values[left->count]);
+            clearSlot(left, left->count);
+            c->count++;
+            p->keys[i - 1] = c->keys[0];
+        } else {
+            Inner* left = (Inner*)p->children[i - 1];
+            Inner* c = (Inner*)p->children[i];
+            shiftInner(c, 0, 1);
+            c->children[1] = c->children[0];
+            c->keys[0] = p->keys[i - 1];
+            c->children[0] = left->children[left->count];
+            c->count++;
+            left->count--;
+            p->keys[i - 1] = SOM_MOVE(left->keys[left->count]);
+        }
+    }
+
+    void borrowFromRight(Inner* p, int i) {
+        if (p->children[i]->leaf) {
+            Leaf* c = (Leaf*)p->children[i];
+            Leaf* right = (Leaf*)p->children[i + 1];
+            c->keys[c->count] = SOM_MOVE(right->keys[0]);
+            c->values[c->count] = SOM_MOVE(right->values[0]);
+            c->count++;
+            shiftLeaf(right, 1, -1);
+            right->count--;
+            clearSlot(right, right->count);
+            p->keys[i] = right->keys[0];
+        } else {
+            Inner* c = (Inner*)p->children[i];
+            Inner* right = (Inner*)p->children[i + 1];
+            c->keys[c->count] = p->keys[i];
+            c->children[c->count + 1] = right->children[0];
+            c->count++;
+            p->keys[i] = SOM_MOVE(right->keys[0]);
+            right->children[0] = right->children[1];
+            shiftInner(right, 1, -1);
+            right->count--;
+        }
+    }
+
+    // appends child i + 1 of p to child i and removes it
+    void merge(Inner* p, int i) {
+        if (p->children[i]->leaf) {
+            Leaf* c = (Leaf*)p->children[i];
+            Leaf* right = (Leaf*)p->children[i + 1];
+            for (int j = 0; j < right->count; j++) {
+                c->keys[c->count + j] = SOM_MOVE(right->keys[j]);
+                c->values[c->count + j] = SOM_MOVE(right->values[j]);
+            }
+            c->count += right->count;
+            c->next = right->next;
+            if (right->next != 0) {
+                right->next->prev = c;
+            } else {
+                last = c;
+            }
+            delete right;
+        } else {
+            Inner* c = (Inner*)p->children[i];
+            Inner* right = (Inner*)p->children[i + 1];
+            c->keys[c->count] = p->keys[i];
+            for (int j = 0; j < right->count; j++) {
+                c->keys[c->count + 1 + j] = SOM_MOVE(right->keys[j]);
+            }
+            for (int j = 0; j <= right->count; j++) {
+                c->children[c->count + 1 + j] = right->children[j];
+            }
+            c->count += right->count + 1;
+            delete right;
+        }
+        shiftInner(p, i + 1, -1);
+        p->count--;
+    }
+};
+
+#endif // _BTREE_H
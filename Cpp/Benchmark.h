@@ -24,9 +24,12 @@
  * THE SOFTWARE.
  */
 
+#include <som/Random.h>
+#include <string>
+
 class Benchmark {
 public:
-    Benchmark(){}
+    Benchmark():rand(0){}
     virtual ~Benchmark(){}
 
     virtual int benchmark() = 0;
@@ -40,6 +43,22 @@ public:
         }
         return true;
     }
+
+    // called by Run after each sample, outside of the timed section and before the
+    // allocator reclaims the memory of the sample; releases what the benchmark only keeps
+    // for verifyResult, otherwise the arena cannot rewind
+    virtual void endSample() {}
+
+    // an additional line for the report of Run given the median time of a sample in
+    // microseconds, e.g. a throughput in the unit of the benchmark; none by default
+    virtual std::string report(double /*median*/) { return std::string(); }
+
+    // the harness gives each instance its own generator, so that instances can run
+    // concurrently; without one, the default generator of the current thread is used
+    void setRandom(som::Random* r) { rand = r; }
+    som::Random& random() { return rand ? *rand : som::Random::threadDefault(); }
+private:
+    som::Random* rand;
 };
 
 #endif // _BENCHMARK_H
@@ -22,6 +22,7 @@
  */
 
 #include "Bounce.h"
+#include "Registry.h"
 #include "som/Random.h"
 #include <algorithm>
 using namespace som;
@@ -34,11 +35,13 @@ int Bounce::benchmark()
         int xVel;
         int yVel;
     public:
-        Ball():x(0),y(0),xVel(0),yVel(0) {
-            x = Random::next() % 500;
-            y = Random::next() % 500;
-            xVel = (Random::next() % 300) - 150;
-            yVel = (Random::next() % 300) - 150;
+        Ball():x(0),y(0),xVel(0),yVel(0) {}
+
+        void init(Random& random) {
+            x = random.next() % 500;
+            y = random.next() % 500;
+            xVel = (random.next() % 300) - 150;
+            yVel = (random.next() % 300) - 150;
         }
 
         bool bounce() {
@@ -56,10 +59,14 @@ int Bounce::benchmark()
         }
     };
 
-    Random::reset();
+    Random& rnd = random();
+    rnd.reset();
     int ballCount = 100;
     int bounces   = 0;
     Ball* balls = new Ball[ballCount];
+    for (int i = 0; i < ballCount; i++) {
+        balls[i].init(rnd);
+    }
 
     for (int i = 0; i < 50; i++) {
         for (int j = 0; j < ballCount; j++) {
@@ -71,3 +78,5 @@ int Bounce::benchmark()
     delete[] balls;
     return bounces;
 }
+
+static Registration<Bounce> registration("Bounce", Registry::Micro, 1500, 1);
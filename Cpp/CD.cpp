@@ -22,7 +22,9 @@
  */
 
 #include "CD.h"
+#include "Registry.h"
 #include "RedBlackTree.h"
+#include "BTree.h"
 #include <iostream>
 #include <math.h>
 #include "som/Vector.h"
@@ -308,6 +310,14 @@ public:
     }
 };
 
+namespace som {
+SOM_RELOCATABLE(Vector3D)
+SOM_RELOCATABLE(CallSign)
+SOM_RELOCATABLE(Aircraft)
+SOM_RELOCATABLE(Collision)
+SOM_RELOCATABLE(Motion)
+}
+
 static const Vector2D horizontal(GOOD_VOXEL_SIZE, 0.0);
 static const Vector2D vertical(0.0, GOOD_VOXEL_SIZE);
 
@@ -316,25 +326,34 @@ static const Vector2D vertical(0.0, GOOD_VOXEL_SIZE);
 // much much more expensive was allocation of 50 in empty Vector while using Vector by value
 // 23'000us vs 1536us
 
+// the ordered map used by the collision detector, see CD_USE_BTREE in BTree.h
+template <class K, class V, class C>
+struct OrderedMap {
+#ifdef CD_USE_BTREE
+    typedef BTree<K, V, C> Type;
+#else
+    typedef RedBlackTree<K, V, C> Type;
+#endif
+};
+
 class CollisionDetector {
-    typedef RedBlackTree<CallSign, Vector3D, CallSign::Compare> State;
+    typedef OrderedMap<CallSign, Vector3D, CallSign::Compare>::Type State;
     State state;
 
 public:
     void handleNewFrame(Vector<Aircraft>& frame, Vector<Collision>& collisions) {
         Vector<Motion> motions;
-        typedef RedBlackTree<CallSign, bool, CallSign::Compare> Seen;
+        typedef OrderedMap<CallSign, bool, CallSign::Compare>::Type Seen;
         Seen seen;
 
 #ifdef USE_FANCY_ITERATORS
         class Iter1 : public ForEachInterface<Aircraft>
         {
-            RedBlackTree<CallSign, bool, CallSign::Compare>& seen;
-            RedBlackTree<CallSign, Vector3D, CallSign::Compare>& state;
+            Seen& seen;
+            State& state;
             Vector<Motion>& motions;
         public:
-            Iter1(RedBlackTree<CallSign, bool, CallSign::Compare>& s1,
-                  RedBlackTree<CallSign, Vector3D, CallSign::Compare>& s2,
+            Iter1(Seen& s1, State& s2,
                   Vector<Motion>& m):seen(s1),state(s2), motions(m){}
             void apply(const Aircraft& aircraft)
             {
@@ -359,7 +378,7 @@ public:
             }
         } iter1(seen, state, motions);
 
-        frame.forEach(iter1);
+        frame.forEach(SOM_DISPATCH(iter1));
 #else
         for( int i = 0; i < frame.size(); i++ )
         {
@@ -393,7 +412,7 @@ public:
             }
         } iter2(seen,toRemove);
 
-        state.forEach(iter2);
+        state.forEach(SOM_DISPATCH(iter2));
 
 #ifdef USE_FANCY_ITERATORS
         class Iter3 : public ForEachInterface<CallSign>
@@ -407,7 +426,7 @@ public:
             }
         } iter3(state);
 
-        toRemove.forEach(iter3);
+        toRemove.forEach(SOM_DISPATCH(iter3));
 #else
         for( int i = 0; i < toRemove.size(); i++ )
         {
@@ -442,7 +461,7 @@ public:
             }
         } iter4(collisions);
 
-        allReduced.forEach(iter4);
+        allReduced.forEach(SOM_DISPATCH(iter4));
 #else
         for( int k = 0; k < allReduced.size(); k++ )
         {
@@ -518,7 +537,8 @@ private:
                  (low_x <= low_y && high_y <= high_x)));
     }
 
-    typedef RedBlackTree<Vector2D, Vector<Motion>, Vector2D::Compare> VoxelMap;
+    typedef OrderedMap<Vector2D, Vector<Motion>, Vector2D::Compare>::Type VoxelMap;
+    typedef OrderedMap<Vector2D, bool, Vector2D::Compare>::Type VoxelSeen;
     static void putIntoMap( VoxelMap& voxelMap, const Vector2D& voxel, const Motion& motion) {
         Vector<Motion>* array = voxelMap.get(voxel);
         if (array == 0) {
@@ -531,7 +551,7 @@ private:
 
     static void recurse(
             VoxelMap& voxelMap,
-            RedBlackTree<Vector2D, bool, Vector2D::Compare>& seen,
+            VoxelSeen& seen,
             const Vector2D& nextVoxel, const Motion& motion) {
         if (!isInVoxel(nextVoxel, motion)) {
             return;
@@ -569,21 +589,14 @@ private:
                 CollisionDetector::drawMotionOnVoxelMap(voxelMap, motion);
             }
         } iter1(voxelMap);
-        motions.forEach(iter1);
+        motions.forEach(SOM_DISPATCH(iter1));
 
-        class Iter2 : public ForEachInterface<VoxelMap::Entry<Vector2D, Vector<Motion> > >
-        {
-            Vector<Vector<Motion> >& result;
-        public:
-            Iter2(Vector<Vector<Motion> >& r):result(r) {}
-            void apply(const VoxelMap::Entry<Vector2D,Vector<Motion> >& e)
-            {
-                if (e.value.size() > 1) {
-                    result.append(e.value);
-                }
+        // the voxel map is discarded afterwards, so the motions can be moved out of it
+        for (VoxelMap::iterator i = voxelMap.begin(); i != voxelMap.end(); ++i) {
+            if (i.value().size() > 1) {
+                result.append(SOM_MOVE(i.value()));
             }
-        } iter2(result);
-        voxelMap.forEach(iter2);
+        }
     }
 
     static Vector2D voxelHash(const Vector3D& position) {
@@ -604,7 +617,7 @@ private:
     }
 
     static void drawMotionOnVoxelMap(VoxelMap& voxelMap, const Motion& motion) {
-        RedBlackTree<Vector2D, bool, Vector2D::Compare> seen;
+        VoxelSeen seen;
         recurse(voxelMap, seen, voxelHash(motion.posOne), motion);
     }
 };
@@ -647,3 +660,6 @@ bool CD::verifyResult(int actualCollisions, int numAircrafts)
     // Checkstyle: resume
     return false;
 }
+
+static const int verifiedInnerIterations[] = { 1000, 500, 250, 200, 100, 10, 2, 0 };
+static Registration<CD> registration("CD", Registry::Macro, 250, 2, verifiedInnerIterations);
@@ -0,0 +1,293 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Clock.h"
+#include "Statistics.h"
+#include <time.h>
+#include <string.h>
+#include <vector>
+
+#if defined(_WIN32) && !defined(__GNUC__)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+// Source: https://stackoverflow.com/questions/10905892/equivalent-of-gettimeday-for-windows/26085827
+
+// MSVC defines this in winsock2.h!?
+typedef struct timeval {
+    long tv_sec;
+    long tv_usec;
+} timeval;
+
+int gettimeofday(struct timeval * tp, struct timezone * tzp)
+{
+    // Note: some broken versions only have 8 trailing zero's, the correct epoch has 9 trailing zero's
+    // This magic number is the number of 100 nanosecond intervals since January 1, 1601 (UTC)
+    // until 00:00:00 January 1, 1970
+    static const uint64_t EPOCH = ((uint64_t) 116444736000000000ULL);
+
+    SYSTEMTIME  system_time;
+    FILETIME    file_time;
+    uint64_t    time;
+
+    GetSystemTime( &system_time );
+    SystemTimeToFileTime( &system_time, &file_time );
+    time =  ((uint64_t)file_time.dwLowDateTime )      ;
+    time += ((uint64_t)file_time.dwHighDateTime) << 32;
+
+    tp->tv_sec  = (long) ((time - EPOCH) / 10000000L);
+    tp->tv_usec = (long) (system_time.wMilliseconds * 1000);
+    return 0;
+}
+#else
+#include <sys/time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HAVE_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+#endif
+
+class GetTimeOfDayClock : public Clock {
+public:
+    const char* name() const { return "gettimeofday"; }
+    Ticks start() { return read(); }
+    Ticks stop() { return read(); }
+    double nanosecondsPerTick() const { return 1000.0; }
+private:
+    static Ticks read() {
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return (Ticks)tv.tv_sec * 1000000 + tv.tv_usec;
+    }
+};
+
+#if defined(_WIN32) && !defined(__GNUC__)
+
+class MonotonicClock : public Clock {
+    double nsPerTick;
+public:
+    MonotonicClock() {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        nsPerTick = 1.0e9 / f.QuadPart;
+    }
+    const char* name() const { return "monotonic"; }
+    Ticks start() { return read(); }
+    Ticks stop() { return read(); }
+    double nanosecondsPerTick() const { return nsPerTick; }
+    static bool supported() { return true; }
+private:
+    static Ticks read() {
+        LARGE_INTEGER c;
+        QueryPerformanceCounter(&c);
+        return c.QuadPart;
+    }
+};
+
+#else
+
+template<int ID>
+class PosixClock : public Clock {
+    const char* id;
+public:
+    PosixClock(const char* name):id(name) {}
+    const char* name() const { return id; }
+    Ticks start() { return read(); }
+    Ticks stop() { return read(); }
+    static bool supported() {
+        struct timespec ts;
+        return clock_gettime(ID, &ts) == 0;
+    }
+    static Ticks read() {
+        struct timespec ts;
+        clock_gettime(ID, &ts);
+        return (Ticks)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+};
+typedef PosixClock<CLOCK_MONOTONIC> MonotonicClock;
+#ifdef CLOCK_MONOTONIC_RAW
+typedef PosixClock<CLOCK_MONOTONIC_RAW> MonotonicRawClock;
+#endif
+
+#endif
+
+#ifdef HAVE_TSC
+
+// Reads the time stamp counter. start() fences so that earlier instructions have
+// completed before the counter is read; stop() uses rdtscp, which waits for the
+// measured code, and fences so that later instructions cannot start early.
+class TscClock : public Clock {
+    double nsPerTick;
+public:
+    TscClock():nsPerTick(0) {}
+    const char* name() const { return "tsc"; }
+    Ticks start() {
+        _mm_lfence();
+        const Ticks t = __rdtsc();
+        _mm_lfence();
+        return t;
+    }
+    Ticks stop() {
+        unsigned int aux;
+        const Ticks t = __rdtscp(&aux);
+        _mm_lfence();
+        return t;
+    }
+    double nanosecondsPerTick() const { return nsPerTick; }
+
+    static bool invariant() {
+        unsigned int regs[4] = { 0, 0, 0, 0 };
+#if defined(_MSC_VER)
+        __cpuid((int*)regs, 0x80000000);
+        if( regs[0] < 0x80000007 )
+            return false;
+        __cpuid((int*)regs, 0x80000007);
+#else
+        if( __get_cpuid_max(0x80000000, 0) < 0x80000007 )
+            return false;
+        __get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+        return (regs[3] & (1 << 8)) != 0;
+    }
+
+    // calibrate against the monotonic clock; the median of a few short rounds
+    void calibrate(Clock* reference) {
+        std::vector<double> rounds;
+        const double window = 20.0e6; // ns
+        for( int i = 0; i < 5; i++ )
+        {
+            const Ticks r0 = reference->start();
+            const Ticks t0 = start();
+            Ticks r1, t1;
+            do {
+                r1 = reference->stop();
+                t1 = stop();
+            } while( (r1 - r0) * reference->nanosecondsPerTick() < window );
+            rounds.push_back((r1 - r0) * reference->nanosecondsPerTick() / (t1 - t0));
+        }
+        nsPerTick = Statistics::median(rounds);
+    }
+};
+
+#endif
+
+static Clock* s_current = 0;
+
+static Clock* createClock(const std::string& name)
+{
+#if defined(_WIN32) && !defined(__GNUC__)
+    if( name == "monotonic" || name.empty() )
+        return new MonotonicClock();
+#else
+#ifdef CLOCK_MONOTONIC_RAW
+    if( name == "monotonic_raw" || name.empty() )
+        return MonotonicRawClock::supported() ? new MonotonicRawClock("monotonic_raw") : 0;
+#endif
+    if( name == "monotonic" || name.empty() )
+        return MonotonicClock::supported() ? new MonotonicClock("monotonic") : 0;
+#endif
+    if( name == "gettimeofday" )
+        return new GetTimeOfDayClock();
+#ifdef HAVE_TSC
+    if( name == "tsc" )
+    {
+        Clock* reference = createClock("");
+        TscClock* tsc = new TscClock();
+        tsc->calibrate(reference);
+        delete reference;
+        return tsc;
+    }
+#endif
+    return 0;
+}
+
+bool Clock::select(const std::string& name)
+{
+    Clock* c = createClock(name);
+    if( c == 0 )
+        return false;
+    if( s_current )
+        delete s_current;
+    s_current = c;
+    return true;
+}
+
+Clock* Clock::current()
+{
+    if( s_current == 0 )
+        select("");
+    return s_current;
+}
+
+const char* Clock::available()
+{
+    return "monotonic_raw, monotonic, gettimeofday, tsc";
+}
+
+double Clock::resolution()
+{
+    double best = 0;
+    for( int i = 0; i < 100; i++ )
+    {
+        const Ticks t0 = start();
+        Ticks t1 = start();
+        while( t1 == t0 )
+            t1 = start();
+        const double d = (t1 - t0) * nanosecondsPerTick();
+        if( best == 0 || d < best )
+            best = d;
+    }
+    return best;
+}
+
+double Clock::overhead()
+{
+    std::vector<double> d(1000);
+    for( int i = 0; i < (int)d.size(); i++ )
+    {
+        const Ticks t0 = start();
+        const Ticks t1 = stop();
+        d[i] = (t1 - t0) * nanosecondsPerTick();
+    }
+    return Statistics::median(d);
+}
+
+void Clock::printInfo(std::ostream& out)
+{
+    Clock* c = current();
+    out << "Clock: " << c->name() << " resolution: " << c->resolution() <<
+           "ns overhead: " << c->overhead() << "ns";
+#ifdef HAVE_TSC
+    if( strcmp(c->name(), "tsc") == 0 )
+    {
+        out << " frequency: " << 1.0 / c->nanosecondsPerTick() << "GHz";
+        if( !TscClock::invariant() )
+            out << " (WARNING: TSC not invariant)";
+    }
+#endif
+    out << std::endl;
+}
@@ -0,0 +1,59 @@
+#ifndef _CLOCK_H
+#define _CLOCK_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <iostream>
+#include <string>
+
+// Timer backend used by Run::measure. start() and stop() return raw ticks; they
+// are separate so that each side can use the appropriate serialization (e.g. the
+// TSC clock fences before reading on start and after reading on stop).
+class Clock {
+public:
+    typedef unsigned long long Ticks;
+
+    virtual ~Clock() {}
+    virtual const char* name() const = 0;
+    virtual Ticks start() = 0;
+    virtual Ticks stop() = 0;
+    virtual double nanosecondsPerTick() const { return 1.0; }
+
+    double toMicroseconds(Ticks elapsed) const {
+        return elapsed * nanosecondsPerTick() / 1000.0;
+    }
+
+    // smallest observable non-zero difference between two reads, in ns
+    double resolution();
+    // median cost of an empty start()/stop() pair, in ns
+    double overhead();
+
+    // The clock selected by name (see available()) or the default one if name is empty;
+    // returns false if the name is unknown or the clock not supported on this machine.
+    static bool select(const std::string& name);
+    static Clock* current();
+    static const char* available();
+
+    static void printInfo(std::ostream&);
+};
+
+#endif // _CLOCK_H
@@ -9,46 +9,84 @@ TEMPLATE = app
 
 HEADERS += \
     som/Dictionary.h \
+    som/FlatDictionary.h \
     som/Interfaces.h \
     som/Random.h \
     som/Set.h \
+    som/Sort.h \
     som/Vector.h \
+    Allocator.h \
+    AllocStats.h \
     Benchmark.h \
     Bounce.h \
+    BTree.h \
     CD.h \
+    Clock.h \
     DeltaBlue.h \
     Havlak.h \
     Json.h \
+    JsonDocument.h \
+    JsonIndexParser.h \
+    JsonParser.h \
+    JsonReader.h \
+    JsonValue.h \
     List.h \
+    MappedFile.h \
     Mandelbrot.h \
     NBody.h \
+    NdJson.h \
     Object.h \
+    PerfCounters.h \
     Permute.h \
     Queens.h \
     RedBlackTree.h \
+    Registry.h \
+    Report.h \
+    Results.h \
     Richards.h \
     Run.h \
     Sieve.h \
+    Sort.h \
+    Statistics.h \
     Storage.h \
+    Thread.h \
     Towers.h
 
 SOURCES += \
     som/Random.cpp \
+    Allocator.cpp \
+    AllocStats.cpp \
     Bounce.cpp \
     CD.cpp \
+    Clock.cpp \
     DeltaBlue.cpp \
     Havlak.cpp \
     Json.cpp \
+    JsonDocument.cpp \
+    JsonIndexParser.cpp \
+    JsonParser.cpp \
+    JsonReader.cpp \
     List.cpp \
     main.cpp \
     Mandelbrot.cpp \
+    MappedFile.cpp \
     NBody.cpp \
+    NdJson.cpp \
+    PerfCounters.cpp \
     Permute.cpp \
     Queens.cpp \
+    Registry.cpp \
+    Report.cpp \
+    Results.cpp \
     Richards.cpp \
     Run.cpp \
     Sieve.cpp \
+    Sort.cpp \
+    Statistics.cpp \
     Storage.cpp \
+    Thread.cpp \
     Towers.cpp
 
 
+
+unix: LIBS += -lpthread
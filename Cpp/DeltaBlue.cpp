@@ -9,7 +9,10 @@
  */
 
 #include "DeltaBlue.h"
+#include "Registry.h"
+#include "Thread.h"
 #include "som/Dictionary.h"
+#include "som/FlatDictionary.h"
 using namespace som;
 
 // NOTE:
@@ -35,22 +38,32 @@ public:
     };
 };
 
+class Strength;
+
+#ifdef SOM_CHAINED_DICTIONARY
+typedef IdentityDictionary<Sym*, int, Sym::Hash> StrengthTable;
+typedef IdentityDictionary<Sym*, Strength*, Sym::Hash> StrengthConstants;
+#else
+typedef FlatIdentityDictionary<Sym*, int, Sym::Hash> StrengthTable;
+typedef FlatIdentityDictionary<Sym*, Strength*, Sym::Hash> StrengthConstants;
+#endif
+
 class Strength {
 public:
 
 
-    static Sym* ABSOLUTE_STRONGEST;
-    static Sym* REQUIRED;
-    static Sym* STRONG_PREFERRED;
-    static Sym* PREFERRED;
-    static Sym* STRONG_DEFAULT;
-    static Sym* DEFAULT;
-    static Sym* WEAK_DEFAULT;
-    static Sym* ABSOLUTE_WEAKEST;
+    static THREAD_LOCAL Sym* ABSOLUTE_STRONGEST;
+    static THREAD_LOCAL Sym* REQUIRED;
+    static THREAD_LOCAL Sym* STRONG_PREFERRED;
+    static THREAD_LOCAL Sym* PREFERRED;
+    static THREAD_LOCAL Sym* STRONG_DEFAULT;
+    static THREAD_LOCAL Sym* DEFAULT;
+    static THREAD_LOCAL Sym* WEAK_DEFAULT;
+    static THREAD_LOCAL Sym* ABSOLUTE_WEAKEST;
 
     Strength(Sym* symbolicValue) {
         this->symbolicValue = symbolicValue;
-        this->arithmeticValue = *strengthTable.at(symbolicValue);
+        this->arithmeticValue = *strengthTable->at(symbolicValue);
     }
     bool sameAs(Strength* s) {
         return arithmeticValue == s->getArithmeticValue();
@@ -77,7 +90,7 @@ public:
     }
 
     static Strength* of(Sym* sym) {
-        return *strengthConstant.at(sym);
+        return *strengthConstant->at(sym);
     }
 
     static Strength* absoluteWeakest() {
@@ -100,8 +113,10 @@ public:
         DEFAULT            = new Sym(5);
         WEAK_DEFAULT       = new Sym(6);
         ABSOLUTE_WEAKEST   = new Sym(7);
-        createStrengthTable(strengthTable);
-        createStrengthConstants(strengthConstant);
+        strengthTable = new StrengthTable();
+        strengthConstant = new StrengthConstants();
+        createStrengthTable(*strengthTable);
+        createStrengthConstants(*strengthConstant);
         absoluteWeakest_   = Strength::of(ABSOLUTE_WEAKEST);
         required_          = Strength::of(REQUIRED);
     }
@@ -109,7 +124,7 @@ public:
     static void deinit()
     {
         Vector<Strength*> vals;
-        strengthConstant.getValues(vals);
+        strengthConstant->getValues(vals);
         for( int i = 0; i < vals.size(); i++ )
             delete vals.at(i);
 
@@ -129,16 +144,17 @@ public:
         DEFAULT            = 0;
         WEAK_DEFAULT       = 0;
         ABSOLUTE_WEAKEST   = 0;
-        strengthTable.removeAll();
-
-        strengthConstant.removeAll();
+        delete strengthTable;
+        strengthTable = 0;
+        delete strengthConstant;
+        strengthConstant = 0;
     }
 
 private:
     int arithmeticValue;
     Sym*   symbolicValue;
 
-    static void createStrengthTable(IdentityDictionary<Sym*, int, Sym::Hash>& strengthTable) {
+    static void createStrengthTable(StrengthTable& strengthTable) {
         strengthTable.atPut(ABSOLUTE_STRONGEST, -10000);
         strengthTable.atPut(REQUIRED,           -800);
         strengthTable.atPut(STRONG_PREFERRED,   -600);
@@ -149,9 +165,9 @@ private:
         strengthTable.atPut(ABSOLUTE_WEAKEST,    10000);
     }
 
-    static void createStrengthConstants(IdentityDictionary<Sym*, Strength*, Sym::Hash>& strengthConstant) {
+    static void createStrengthConstants(StrengthConstants& strengthConstant) {
         Vector<Sym*> keys;
-        strengthTable.getKeys(keys);
+        strengthTable->getKeys(keys);
         for( int i = 0; i < keys.size(); i++ )
         {
             Sym* key = keys.at(i);
@@ -159,25 +175,26 @@ private:
         }
     }
 
-    static Strength* absoluteWeakest_;
-    static Strength* required_;
-    static IdentityDictionary<Sym*, int, Sym::Hash>  strengthTable;
-    static IdentityDictionary<Sym*, Strength*, Sym::Hash> strengthConstant;
+    // per thread, so that concurrent DeltaBlue instances each have their own tables
+    static THREAD_LOCAL Strength* absoluteWeakest_;
+    static THREAD_LOCAL Strength* required_;
+    static THREAD_LOCAL StrengthTable* strengthTable;
+    static THREAD_LOCAL StrengthConstants* strengthConstant;
 };
 
-Strength* Strength::absoluteWeakest_ = 0;
-Strength* Strength::required_ = 0;
-IdentityDictionary<Sym*, int, Sym::Hash>  Strength::strengthTable;
-IdentityDictionary<Sym*, Strength*, Sym::Hash> Strength::strengthConstant;
+THREAD_LOCAL Strength* Strength::absoluteWeakest_ = 0;
+THREAD_LOCAL Strength* Strength::required_ = 0;
+THREAD_LOCAL StrengthTable* Strength::strengthTable = 0;
+THREAD_LOCAL StrengthConstants* Strength::strengthConstant = 0;
 
-Sym* Strength::ABSOLUTE_STRONGEST = 0;
-Sym* Strength::REQUIRED           = 0;
-Sym* Strength::STRONG_PREFERRED   = 0;
-Sym* Strength::PREFERRED          = 0;
-Sym* Strength::STRONG_DEFAULT     = 0;
-Sym* Strength::DEFAULT            = 0;
-Sym* Strength::WEAK_DEFAULT       = 0;
-Sym* Strength::ABSOLUTE_WEAKEST   = 0;
+THREAD_LOCAL Sym* Strength::ABSOLUTE_STRONGEST = 0;
+THREAD_LOCAL Sym* Strength::REQUIRED           = 0;
+THREAD_LOCAL Sym* Strength::STRONG_PREFERRED   = 0;
+THREAD_LOCAL Sym* Strength::PREFERRED          = 0;
+THREAD_LOCAL Sym* Strength::STRONG_DEFAULT     = 0;
+THREAD_LOCAL Sym* Strength::DEFAULT            = 0;
+THREAD_LOCAL Sym* Strength::WEAK_DEFAULT       = 0;
+THREAD_LOCAL Sym* Strength::ABSOLUTE_WEAKEST   = 0;
 
 class Planner;
 class Variable;
@@ -583,7 +600,7 @@ protected:
                 return c1->getStrength()->stronger(c2->getStrength()) ? -1 : 1;
             }
         } it;
-        unsatisfied.sort(it);
+        unsatisfied.sort(SOM_DISPATCH(it));
     }
 
 public:
@@ -1124,3 +1141,5 @@ bool DeltaBlue::innerBenchmarkLoop(int innerIterations)
     Strength::deinit();
     return true;
 }
+
+static Registration<DeltaBlue> registration("DeltaBlue", Registry::Macro, 12000, 1);
@@ -37,9 +37,11 @@
 // than the standard one would help
 
 #include "Havlak.h"
+#include "Registry.h"
 #include "som/Vector.h"
 #include "som/Set.h"
 #include "som/Dictionary.h"
+#include "som/FlatDictionary.h"
 #include <utility>
 #include <iostream>
 #include <cassert>
@@ -263,7 +265,7 @@ public:
                 iter->unite(parent);
             }
         } it(parent);
-        nodeList.forEach(it);
+        nodeList.forEach(SOM_DISPATCH(it));
         return node;
     }
 
@@ -335,7 +337,7 @@ public:
                 }
             }
         } it(root);
-        loops.forEach(it);
+        loops.forEach(SOM_DISPATCH(it));
 
         // recursively traverse the tree and assign levels.
         calculateNestingLevelRec(root, 0);
@@ -357,7 +359,7 @@ public:
                                           1 + liter->getNestingLevel()));
             }
         } it(loop,depth);
-        loop->getChildren().forEach(it);
+        loop->getChildren().forEach(SOM_DISPATCH(it));
     }
 
     int getNumLoops() const {
@@ -390,7 +392,11 @@ class HavlakLoopFinder {
 
     Vector<Set<int> >  nonBackPreds;
     Vector<Vector<int> > backPreds;
+#ifdef SOM_CHAINED_DICTIONARY
     typedef IdentityDictionary<BasicBlock*, int, BasicBlock::Hash> Number;
+#else
+    typedef FlatIdentityDictionary<BasicBlock*, int, BasicBlock::Hash> Number;
+#endif
     Number number;
     int maxSize;
     Vector<int>                    header;
@@ -439,6 +445,9 @@ public:
             nonBackPreds.expand(size);
             maxSize = size;
         }
+        // the elements up to size - 1 are default constructed in place
+        backPreds.atPut(size - 1, Vector<int>());
+        nonBackPreds.atPut(size - 1, Set<int>());
 
         for (int i = 0; i < size; ++i) {
             nodes.atPut(i, new UnionFindNode());
@@ -484,7 +493,7 @@ public:
                         workList.append(niter);
                     }
                 } it(workList);
-                nodePool.forEach(it);
+                nodePool.forEach(SOM_DISPATCH(it));
 
                 if (nodePool.size() != 0) {
                     type.atPut(w, BB_REDUCIBLE);
@@ -580,7 +589,7 @@ private:
                 number.atPut(bb, UNVISITED);
             }
         } it(number);
-        cfg->getBasicBlocks().forEach(it);
+        cfg->getBasicBlocks().forEach(SOM_DISPATCH(it));
 
         doDFS(cfg->getStartBasicBlock(), 0);
     }
@@ -630,7 +639,7 @@ private:
                     }
                 }
             } it(this,w);
-            nodeW->getInEdges().forEach(it);
+            nodeW->getInEdges().forEach(SOM_DISPATCH(it));
         }
     }
 
@@ -666,7 +675,7 @@ private:
                                 return e == ydash;
                             }
                         } it(ydash);
-                        if (!nodePool.hasSome(it)) {
+                        if (!nodePool.hasSome(SOM_DISPATCH(it))) {
                             workList.append(ydash);
                             nodePool.append(ydash);
                         }
@@ -674,7 +683,7 @@ private:
                 }
             }
         } it(this,w,nodePool,workList);
-        nonBackPreds.at(x->getDfsNumber()).forEach(it);
+        nonBackPreds.at(x->getDfsNumber()).forEach(SOM_DISPATCH(it));
     }
 
     void setLoopAttributes(int w, Vector<UnionFindNode*>& nodePool, SimpleLoop* loop) {
@@ -713,7 +722,7 @@ private:
                 }
             }
         } it(this,w,loop);
-        nodePool.forEach(it);
+        nodePool.forEach(SOM_DISPATCH(it));
     }
 
     void stepD(int w, Vector<UnionFindNode*>& nodePool) {
@@ -733,7 +742,7 @@ private:
                 }
             }
         } it(this,w,nodePool);
-        backPreds.at(w).forEach(it);
+        backPreds.at(w).forEach(SOM_DISPATCH(it));
     }
 };
 
@@ -884,4 +893,5 @@ bool Havlak::verifyResult(int a, int b, int innerIterations)
 
 }
 
-
+static const int verifiedInnerIterations[] = { 15000, 1500, 150, 15, 1, 0 };
+static Registration<Havlak> registration("Havlak", Registry::Macro, 10, 1, verifiedInnerIterations);
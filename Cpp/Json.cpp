@@ -23,261 +23,37 @@
  ******************************************************************************/
 
 #include "Json.h"
-#include "Object.h"
-#include "som/Vector.h"
+#include "Registry.h"
+#include "JsonValue.h"
+#include "JsonParser.h"
+#include "JsonIndexParser.h"
+#include "JsonDocument.h"
+#include "JsonReader.h"
+#include "NdJson.h"
+#include "MappedFile.h"
+#include "Thread.h"
+#include "Clock.h"
+#include "Statistics.h"
 #include <string>
-
-class JsonObject;
-class JsonArray;
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <stdlib.h>
+#include <stdio.h>
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
 
 // if NO_GC and current is std::string then 7283us, with GC 7496us
 // if NO_GC and current is char then 3782us, with GC 3930us
 // compare to 3946us for generated plain C with Boehm GC
 // NOTE: I checked that all JsonValue are deleted after the run
-
-class JsonValue : public Object{
-public:
-    virtual bool isObject() {
-        return false;
-    }
-
-    virtual bool isArray() {
-        return false;
-    }
-
-    virtual bool isNumber() {
-        return false;
-    }
-
-    virtual bool isString() {
-        return false;
-    }
-
-    virtual bool isBoolean() {
-        return false;
-    }
-
-    virtual bool isTrue() {
-        return false;
-    }
-
-    virtual bool isFalse() {
-        return false;
-    }
-
-    virtual bool isNull() {
-        return false;
-    }
-
-    virtual JsonObject* asObject() {
-        throw "Not an object";
-    }
-
-    virtual JsonArray* asArray() {
-        throw "Not an array";
-    }
-};
-
-class JsonObject : public JsonValue {
-
-    som::Vector<std::string> names;
-    som::Vector< Ref<JsonValue> > values;
-
-
-    class HashIndexTable {
-
-        int* hashTable;
-        int len;
-    public:
-        HashIndexTable() {
-            len = 32;
-            hashTable = new int[len]; // must be a power of two
-        }
-        ~HashIndexTable()
-        {
-            delete[] hashTable;
-        }
-
-        void add(const std::string& name, int index) {
-            int slot = hashSlotFor(name);
-            if (index < 0xff) {
-                // increment by 1, 0 stands for empty
-                hashTable[slot] = (index + 1) & 0xff;
-            } else {
-                hashTable[slot] = 0;
-            }
-        }
-
-        int get(const std::string& name) {
-            int slot = hashSlotFor(name);
-            // subtract 1, 0 stands for empty
-            return (hashTable[slot] & 0xff) - 1;
-        }
-
-    private:
-        int stringHash(const std::string& s) {
-            // this is not a proper hash, but sufficient for the benchmark,
-            // and very portable!
-            return s.size() * 1402589;
-        }
-
-        int hashSlotFor(const std::string& element) {
-            return stringHash(element) & len - 1;
-        }
-    };
-    HashIndexTable table;
-
-public:
-    JsonObject* add(const std::string& name, JsonValue* value) {
-        if (name.empty()) {
-            throw "name is null";
-        }
-        if (value == 0) {
-            throw "value is null";
-        }
-        table.add(name, names.size());
-        names.append(name);
-        values.append(value);
-        return this;
-    }
-
-    JsonValue* get(const std::string& name) {
-        if (name.empty()) {
-            throw "name is null";
-        }
-        const int index = indexOf(name);
-        return index == -1 ? 0 : values.at(index);
-    }
-
-    int size() {
-        return names.size();
-    }
-
-    bool isEmpty() {
-        return names.isEmpty();
-    }
-
-    bool isObject() {
-        return true;
-    }
-
-    JsonObject* asObject() {
-        return this;
-    }
-
-private:
-    int indexOf(const std::string& name) {
-        int index = table.get(name);
-        if (index != -1 && name == names.at(index)) {
-            return index;
-        }
-        throw "Not needed for benchmark";
-    }
-};
-
-class JsonArray : public JsonValue {
-
-    som::Vector< Ref<JsonValue> > values;
-
-public:
-    JsonArray* add(JsonValue* value) {
-        if (value == 0) {
-            throw "value is null";
-        }
-        values.append(value);
-        return this;
-    }
-
-    int size() {
-        return values.size();
-    }
-
-    JsonValue* get(int index) {
-        return values.at(index);
-    }
-
-    bool isArray() {
-        return true;
-    }
-
-    JsonArray* asArray() {
-        return this;
-    }
-};
-
-
-class JsonString : public JsonValue {
-
-    std::string string;
-
-public:
-    JsonString(const std::string& string) {
-        this->string = string;
-    }
-
-    bool isString() {
-        return true;
-    }
-};
-
-class JsonNumber : public JsonValue {
-
-    std::string string;
-
-public:
-    JsonNumber(const std::string& string) {
-        this->string = string;
-        if (string.empty()) {
-            throw "string is null";
-        }
-    }
-
-    const std::string& toString() {
-        return string;
-    }
-
-    bool isNumber() {
-        return true;
-    }
-};
-
-class JsonLiteral : public JsonValue {
-
-
-    std::string value;
-    bool isNull_;
-    bool isTrue_;
-    bool isFalse_;
-
-public:
-    JsonLiteral(const std::string& value) {
-        this->value = value;
-        isNull_  = value == "null";
-        isTrue_  = value == "true";
-        isFalse_ = value == "false";
-    }
-
-    const std::string& toString() {
-        return value;
-    }
-
-    bool isNull() {
-        return isNull_;
-    }
-
-    bool isTrue() {
-        return isTrue_;
-    }
-
-    bool isFalse() {
-        return isFalse_;
-    }
-
-    bool isBoolean() {
-        return isTrue_ || isFalse_;
-    }
-};
-
+// JsonDom avoids both, it parses into a JsonDocument, whose nodes are neither reference
+// counted nor allocated one by one
 
 class JsonPureStringParser {
 
@@ -558,7 +334,7 @@ private:
         }
         index++;
         if (index < input.size()) {
-            current = input.substr(index, 1)[0];
+            current = input[index];
         } else {
             current = 0;
         }
@@ -617,11 +393,37 @@ class Json::Imp
 {
 public:
     Ref<JsonValue> res;
+    JsonDocument doc;
+    std::string input;
+    int copies;
+    Mode mode;
 };
 
 Json::Json()
 {
     imp = new Imp();
+    imp->input = rapBenchmarkMinified;
+    imp->copies = 1;
+    imp->mode = Tree;
+}
+
+Json::Json(int copies, Mode mode)
+{
+    imp = new Imp();
+    imp->copies = copies;
+    imp->mode = mode;
+    if( copies > 1 )
+    {
+        imp->input = "[";
+        for( int i = 0; i < copies; i++ )
+        {
+            if( i != 0 )
+                imp->input += ",";
+            imp->input += rapBenchmarkMinified;
+        }
+        imp->input += "]";
+    }else
+        imp->input = rapBenchmarkMinified;
 }
 
 Json::~Json()
@@ -631,14 +433,28 @@ Json::~Json()
 
 int Json::benchmark()
 {
-    JsonPureStringParser p(rapBenchmarkMinified);
+    if( imp->mode == IndexedTree )
+    {
+        JsonIndexParser p(imp->input.data(), imp->input.size());
+        imp->res = p.parse();
+        return 0;
+    }
+    if( imp->mode == Document )
+    {
+        imp->doc.parse(imp->input.data(), imp->input.size());
+        return 0;
+    }
+#ifdef JSON_PURE_STRING_PARSER
+    JsonPureStringParser p(imp->input);
+#else
+    JsonParser p(imp->input.data(), imp->input.size());
+#endif
     imp->res = p.parse();
     return 0;
 }
 
-bool Json::verifyResult(int r)
+static bool verifyRap(JsonValue* result)
 {
-    JsonValue* result = imp->res;
     if( result == 0 )
         return false;
     if (!result->isObject()) { return false; }
@@ -646,3 +462,268 @@ bool Json::verifyResult(int r)
     if (!result->asObject()->get("operations")->isArray()) { return false; }
     return result->asObject()->get("operations")->asArray()->size() == 156;
 }
+
+static bool verifyRap(const JsonNode& result)
+{
+    if( !result.isObject() )
+        return false;
+    const JsonNode* head = result.get("head");
+    const JsonNode* operations = result.get("operations");
+    if( head == 0 || !head->isObject() )
+        return false;
+    return operations != 0 && operations->isArray() && operations->size() == 156;
+}
+
+bool Json::verifyResult(int r)
+{
+    if( imp->mode == Document )
+    {
+        const JsonNode& result = imp->doc.root();
+        if( imp->copies == 1 )
+            return verifyRap(result);
+        if( !result.isArray() || result.size() != imp->copies )
+            return false;
+        return verifyRap(result.at(0)) && verifyRap(result.at(imp->copies - 1));
+    }
+    JsonValue* result = imp->res;
+    if( imp->copies == 1 )
+        return verifyRap(result);
+    if( result == 0 || !result->isArray() || result->asArray()->size() != imp->copies )
+        return false;
+    return verifyRap(result->asArray()->get(0)) && verifyRap(result->asArray()->get(imp->copies - 1));
+}
+
+void Json::endSample()
+{
+    // the tree of the last iteration would keep the arena from rewinding
+    imp->res = 0;
+}
+
+// Generates "[" input "," input "," .. input "]" with the given number of copies.
+class RapSource : public JsonReader::Source {
+public:
+    RapSource(const char* input, int copies):input(input),len(strlen(input)),copies(copies),
+        copy(-1),offset(0),bytes(0) {}
+    int read(char* buffer, int size) {
+        int n = 0;
+        while( n < size )
+        {
+            if( copy < 0 )
+            {
+                buffer[n++] = '[';
+                copy = 0;
+            }else if( copy == copies )
+            {
+                buffer[n++] = ']';
+                copy++;
+            }else if( copy > copies )
+                break;
+            else if( offset == len )
+            {
+                if( copy + 1 < copies )
+                    buffer[n++] = ',';
+                copy++;
+                offset = 0;
+            }else
+            {
+                const int k = std::min(size - n, len - offset);
+                memcpy(buffer + n, input + offset, k);
+                n += k;
+                offset += k;
+            }
+        }
+        bytes += n;
+        return n;
+    }
+    long long bytesRead() const { return bytes; }
+private:
+    const char* input;
+    int len;
+    int copies;
+    int copy;   // -1 before the opening bracket, copies before the closing one
+    int offset; // in the current copy
+    long long bytes;
+};
+
+// peak resident set size of the process in MB, or 0 if unknown
+static double peakRss()
+{
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage u;
+    if( getrusage(RUSAGE_SELF, &u) != 0 )
+        return 0;
+#if defined(__APPLE__)
+    return u.ru_maxrss / 1048576.0; // bytes
+#else
+    return u.ru_maxrss / 1024.0; // kilobytes
+#endif
+#endif
+}
+
+class JsonStream::Imp
+{
+public:
+    int eventsPerCopy;
+    long long bytes;    // of the last sample
+    int readerMemory;   // of the last sample
+};
+
+JsonStream::JsonStream()
+{
+    imp = new Imp();
+    JsonDocument doc;
+    doc.parse(rapBenchmarkMinified, strlen(rapBenchmarkMinified));
+    imp->eventsPerCopy = doc.nodeCount();
+    imp->bytes = 0;
+    imp->readerMemory = 0;
+}
+
+JsonStream::~JsonStream()
+{
+    delete imp;
+}
+
+static int copiesFor(int megabytes)
+{
+    const int len = strlen(rapBenchmarkMinified) + 1;
+    return (int)(((long long)megabytes * 1024 * 1024 + len - 1) / len);
+}
+
+int JsonStream::benchmark(int megabytes)
+{
+    RapSource source(rapBenchmarkMinified, copiesFor(megabytes));
+    JsonReader reader(&source);
+    int events = 0;
+    int memory = 0;
+    while( true )
+    {
+        const JsonReader::Event e = reader.next();
+        if( e == JsonReader::End )
+            break;
+        if( e != JsonReader::EndObject && e != JsonReader::EndArray )
+            events++;
+        if( reader.depth() == 1 )
+            memory = std::max(memory, reader.memoryUsed());
+    }
+    imp->bytes = source.bytesRead();
+    imp->readerMemory = std::max(memory, reader.memoryUsed());
+    return events;
+}
+
+bool JsonStream::verifyResult(int events, int megabytes)
+{
+    return events == copiesFor(megabytes) * imp->eventsPerCopy + 1;
+}
+
+std::string JsonStream::report(double median)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << "throughput: " <<
+           (median > 0 ? imp->bytes / median * 1.0e6 / 1048576.0 : 0) << " MB/s reader memory: " <<
+           imp->readerMemory / 1024.0 << " KB peak RSS: " << peakRss() << " MB";
+    return out.str();
+}
+
+class JsonLines::Imp
+{
+public:
+    MappedFile file;
+    std::string generated;  // path of the generated file, if any
+    std::string error;      // of the generation or opening of the file
+    int documents;          // expected, or -1 if unknown
+    long long nodes;
+    std::vector<int> threads;
+    std::vector<ThreadPool*> pools;
+    std::vector< std::vector<double> > samples; // per number of threads, us
+};
+
+JsonLines::JsonLines()
+{
+    imp = new Imp();
+    imp->documents = -1;
+    imp->nodes = 0;
+    const char* path = getenv("AWFY_NDJSON");
+    if( path == 0 )
+    {
+        const char* dir = getenv("TMPDIR");
+#if defined(_WIN32)
+        if( dir == 0 )
+            dir = getenv("TEMP");
+#endif
+        char name[64];
+        sprintf(name, "/awfy-%d-%p.ndjson", (int)getpid(), (void*)this);
+        imp->generated = std::string(dir ? dir : "/tmp") + name;
+        if( !NdJson::generate(imp->generated, 32, imp->documents, imp->nodes, imp->error) )
+            return;
+        path = imp->generated.c_str();
+    }
+    imp->file.open(path, imp->error);
+}
+
+JsonLines::~JsonLines()
+{
+    for( int i = 0; i < (int)imp->pools.size(); i++ )
+        delete imp->pools[i];
+    imp->file.close();
+    if( !imp->generated.empty() )
+        remove(imp->generated.c_str());
+    delete imp;
+}
+
+bool JsonLines::innerBenchmarkLoop(int innerIterations)
+{
+    if( !imp->error.empty() )
+        throw imp->error;
+    if( imp->threads.empty() )
+    {
+        for( int t = 1; t < innerIterations; t *= 2 )
+            imp->threads.push_back(t);
+        imp->threads.push_back(innerIterations);
+        imp->samples.resize(imp->threads.size());
+        for( int i = 0; i < (int)imp->threads.size(); i++ )
+            imp->pools.push_back(new ThreadPool(imp->threads[i] - 1)); // the caller helps in wait()
+    }
+    Clock* clock = Clock::current();
+    for( int i = 0; i < (int)imp->threads.size(); i++ )
+    {
+        const Clock::Ticks start = clock->start();
+        const NdJson::Result res = NdJson::parse(imp->file.data(), imp->file.size(), imp->pools[i]);
+        const Clock::Ticks end = clock->stop();
+        imp->samples[i].push_back(clock->toMicroseconds(end - start));
+        if( res.error != 0 || res.documents == 0 )
+            return false;
+        if( imp->documents >= 0 && (res.documents != imp->documents || res.nodes != imp->nodes) )
+            return false;
+    }
+    return true;
+}
+
+std::string JsonLines::report(double /*median*/)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << (imp->file.isMapped() ? "mapped " : "read ") <<
+           imp->file.size() / 1048576.0 << " MB, throughput by threads:";
+    double single = 0;
+    for( int i = 0; i < (int)imp->threads.size(); i++ )
+    {
+        const double us = Statistics::median(imp->samples[i]);
+        const double mbs = us > 0 ? imp->file.size() / us * 1.0e6 / 1048576.0 : 0;
+        if( i == 0 )
+            single = mbs;
+        out << " " << imp->threads[i] << ": " << mbs << " MB/s";
+        if( i > 0 && single > 0 )
+            out << " (" << std::setprecision(2) << mbs / single << "x)" << std::setprecision(1);
+    }
+    return out.str();
+}
+
+static Registration<Json> registration("Json", Registry::Macro, 100, 1);
+static Registration<JsonSimd> registration2("JsonSimd", Registry::Macro, 100, 1);
+static Registration<JsonDom> registration3("JsonDom", Registry::Macro, 100, 1);
+static Registration<JsonLarge> registration4("JsonLarge", Registry::Macro, 20, 1);
+static Registration<JsonSimdLarge> registration5("JsonSimdLarge", Registry::Macro, 20, 1);
+static Registration<JsonDomLarge> registration6("JsonDomLarge", Registry::Macro, 20, 1);
+static Registration<JsonStream> registration7("JsonStream", Registry::Macro, 5, 256);
+static Registration<JsonLines> registration8("JsonLines", Registry::Macro, 10, 4);
@@ -35,6 +35,93 @@ public:
     int benchmark();
 
     bool verifyResult(int r);
+
+    void endSample();
+protected:
+    // Tree and IndexedTree build JsonValues with JsonParser and JsonIndexParser,
+    // Document builds a JsonDocument
+    enum Mode { Tree, IndexedTree, Document };
+    // parses an array of the given number of copies of the input if copies > 1
+    Json(int copies, Mode mode);
+private:
+    class Imp;
+    Imp* imp;
+};
+
+// JsonSimd parses the same input with the two stage JsonIndexParser, JsonDom into a
+// JsonDocument; the Large variants parse an array of 64 copies of it.
+class JsonSimd : public Json {
+public:
+    JsonSimd():Json(1, IndexedTree) {}
+};
+
+class JsonDom : public Json {
+public:
+    JsonDom():Json(1, Document) {}
+};
+
+class JsonLarge : public Json {
+public:
+    JsonLarge():Json(64, Tree) {}
+};
+
+class JsonSimdLarge : public Json {
+public:
+    JsonSimdLarge():Json(64, IndexedTree) {}
+};
+
+class JsonDomLarge : public Json {
+public:
+    JsonDomLarge():Json(64, Document) {}
+};
+
+// Streams a generated document of innerIterations MB, an array of copies of the input,
+// through a JsonReader and reports the throughput and the peak resident set size.
+class JsonStream : public Benchmark {
+    int benchmark(int megabytes);
+    bool verifyResult(int events, int megabytes);
+public:
+    JsonStream();
+    ~JsonStream();
+
+    bool innerBenchmarkLoop(int innerIterations) {
+        return verifyResult(benchmark(innerIterations), innerIterations);
+    }
+
+    int benchmark() {
+        throw "Should never be reached";
+    }
+
+    bool verifyResult(int result) {
+        throw "Should never be reached";
+    }
+
+    std::string report(double median);
+private:
+    class Imp;
+    Imp* imp;
+};
+
+// Parses newline delimited JSON from a file which is mapped into memory: the file named
+// by the AWFY_NDJSON environment variable, or a generated temporary one of 32 MB. Each
+// sample parses it with 1, 2, 4 .. innerIterations threads and the report lists the
+// throughput of each number of threads.
+class JsonLines : public Benchmark {
+public:
+    JsonLines();
+    ~JsonLines();
+
+    bool innerBenchmarkLoop(int innerIterations);
+
+    int benchmark() {
+        throw "Should never be reached";
+    }
+
+    bool verifyResult(int result) {
+        throw "Should never be reached";
+    }
+
+    std::string report(double median);
 private:
     class Imp;
     Imp* imp;
@@ -0,0 +1,328 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JsonDocument.h"
+#include "JsonParser.h"
+#include "Allocator.h"
+
+// Parses like JsonParser, but pushes the nodes on a stack; when an array or object is
+// complete, its elements or members are moved from the stack to the document.
+class JsonDocument::Parser {
+public:
+    Parser(JsonDocument* doc, const char* data, int size):
+        doc(doc),pos(data),end(data + size),depth(0) {}
+    JsonNode parse();
+private:
+    void readValue();
+    void readArray();
+    void readObject();
+    void readLiteral(const char* literal, JsonNode::Kind kind);
+    void readNumber();
+    void readString();
+    bool readChar(char ch);
+    void skipWhiteSpace();
+
+    char current() const { return pos < end ? *pos : 0; }
+    void push(const JsonNode& n) {
+        if( depth == doc->stackCapacity )
+        {
+            doc->stackCapacity = doc->stackCapacity ? doc->stackCapacity * 2 : 64;
+            doc->stack = (JsonNode*)Allocator::reallocate(doc->stack, doc->stackCapacity * sizeof(JsonNode));
+        }
+        doc->stack[depth++] = n;
+    }
+    const JsonNode* stack() const { return doc->stack; }
+
+    JsonDocument* doc;
+    const char* pos;
+    const char* end;
+    std::string unescaped;
+    int depth;
+};
+
+JsonNode JsonDocument::Parser::parse()
+{
+    skipWhiteSpace();
+    readValue();
+    skipWhiteSpace();
+    if( pos < end )
+        throw "Unexpected character";
+    return stack()[0];
+}
+
+void JsonDocument::Parser::readValue()
+{
+    switch( current() )
+    {
+    case 'n':
+        readLiteral("null", JsonNode::NullValue);
+        break;
+    case 't':
+        readLiteral("true", JsonNode::TrueValue);
+        break;
+    case 'f':
+        readLiteral("false", JsonNode::FalseValue);
+        break;
+    case '"':
+        readString();
+        break;
+    case '[':
+        readArray();
+        break;
+    case '{':
+        readObject();
+        break;
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        readNumber();
+        break;
+    default:
+        throw "expected value";
+    }
+}
+
+void JsonDocument::Parser::readArray()
+{
+    pos++;
+    const int mark = depth;
+    skipWhiteSpace();
+    if( !readChar(']') )
+    {
+        do
+        {
+            skipWhiteSpace();
+            readValue();
+            skipWhiteSpace();
+        } while( readChar(',') );
+        if( !readChar(']') )
+            throw "expected ',' or ']'";
+    }
+    const int n = depth - mark;
+    JsonNode* elements = 0;
+    if( n )
+    {
+        elements = (JsonNode*)doc->allocate(n * sizeof(JsonNode));
+        memcpy(elements, stack() + mark, n * sizeof(JsonNode));
+    }
+    depth = mark;
+    push(node(JsonNode::ArrayValue, n, elements));
+}
+
+void JsonDocument::Parser::readObject()
+{
+    pos++;
+    const int mark = depth;
+    skipWhiteSpace();
+    if( !readChar('}') )
+    {
+        do
+        {
+            skipWhiteSpace();
+            if( current() != '"' )
+                throw "expected name";
+            readString();
+            skipWhiteSpace();
+            if( !readChar(':') )
+                throw "expected ':'";
+            skipWhiteSpace();
+            readValue();
+            skipWhiteSpace();
+        } while( readChar(',') );
+        if( !readChar('}') )
+            throw "expected ',' or '}'";
+    }
+    // names and values alternate on the stack
+    const int n = (depth - mark) / 2;
+    JsonMember* members = 0;
+    if( n )
+    {
+        members = (JsonMember*)doc->allocate(n * sizeof(JsonMember));
+        for( int i = 0; i < n; i++ )
+        {
+            members[i].name = stack()[mark + 2 * i];
+            members[i].value = stack()[mark + 2 * i + 1];
+        }
+    }
+    depth = mark;
+    push(node(JsonNode::ObjectValue, n, members));
+}
+
+void JsonDocument::Parser::readLiteral(const char* literal, JsonNode::Kind kind)
+{
+    const int len = strlen(literal);
+    if( end - pos < len || memcmp(pos, literal, len) != 0 )
+        throw "expected literal";
+    pos += len;
+    push(node(kind, 0, 0));
+}
+
+void JsonDocument::Parser::readNumber()
+{
+    const int len = JsonParser::scanNumber(pos, end);
+    if( len < 0 )
+        throw "expected digit";
+    push(node(JsonNode::NumberValue, len, pos));
+    pos += len;
+}
+
+void JsonDocument::Parser::readString()
+{
+    pos++;
+    const char* start = pos;
+    while( pos < end && *pos != '"' && *pos != '\\' )
+        pos++;
+    if( pos == end )
+        throw "unterminated string";
+    if( *pos == '"' )
+    {
+        push(node(JsonNode::StringValue, pos - start, start));
+        pos++;
+        return;
+    }
+    while( pos < end && *pos != '"' )
+        pos += *pos == '\\' ? 2 : 1;
+    if( pos >= end )
+        throw "unterminated string";
+    JsonParser::unescape(start, pos, unescaped);
+    pos++;
+    char* text = (char*)doc->allocate(unescaped.size());
+    memcpy(text, unescaped.data(), unescaped.size());
+    push(node(JsonNode::StringValue, unescaped.size(), text));
+}
+
+bool JsonDocument::Parser::readChar(char ch)
+{
+    if( pos == end || *pos != ch )
+        return false;
+    pos++;
+    return true;
+}
+
+void JsonDocument::Parser::skipWhiteSpace()
+{
+    while( pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r') )
+        pos++;
+}
+
+const JsonNode* JsonNode::get(const char* name) const
+{
+    const int n = strlen(name);
+    for( int i = 0; i < len; i++ )
+    {
+        const JsonNode& key = u.members[i].name;
+        if( key.len == n && memcmp(key.u.text, name, n) == 0 )
+            return &u.members[i].value;
+    }
+    return 0;
+}
+
+JsonDocument::JsonDocument():chunks(0),current(0),stack(0),stackCapacity(0)
+{
+    top = node(JsonNode::NullValue, 0, 0);
+}
+
+JsonDocument::~JsonDocument()
+{
+    while( chunks )
+    {
+        Chunk* c = chunks;
+        chunks = c->next;
+        Allocator::deallocate(c);
+    }
+    Allocator::deallocate(stack);
+}
+
+const JsonNode& JsonDocument::parse(const char* data, int size)
+{
+    top = node(JsonNode::NullValue, 0, 0);
+    current = chunks;
+    if( current )
+        current->used = 0;
+    Parser p(this, data, size);
+    top = p.parse();
+    return top;
+}
+
+static int countNodes(const JsonNode& n)
+{
+    int count = 1;
+    if( n.isArray() )
+    {
+        for( int i = 0; i < n.size(); i++ )
+            count += countNodes(n.at(i));
+    }else if( n.isObject() )
+    {
+        for( int i = 0; i < n.size(); i++ )
+            count += 1 + countNodes(n.member(i).value);
+    }
+    return count;
+}
+
+int JsonDocument::nodeCount() const
+{
+    return countNodes(top);
+}
+
+size_t JsonDocument::bytesUsed() const
+{
+    if( current == 0 )
+        return 0;
+    size_t n = 0;
+    for( Chunk* c = chunks; c != current; c = c->next )
+        n += c->used;
+    return n + current->used;
+}
+
+void* JsonDocument::allocate(size_t size)
+{
+    size = (size + 7) & ~(size_t)7;
+    if( current == 0 || current->used + size > current->size )
+    {
+        // continue with the following chunk if big enough, otherwise insert a new one
+        Chunk* next = current ? current->next : chunks;
+        if( next == 0 || next->size < size )
+        {
+            const size_t n = size > (size_t)CHUNK_SIZE ? size : (size_t)CHUNK_SIZE;
+            Chunk* c = (Chunk*)Allocator::allocate(sizeof(Chunk) + n);
+            c->size = n;
+            c->next = next;
+            if( current )
+                current->next = c;
+            else
+                chunks = c;
+            next = c;
+        }
+        next->used = 0;
+        current = next;
+    }
+    void* p = (char*)(current + 1) + current->used;
+    current->used += size;
+    return p;
+}
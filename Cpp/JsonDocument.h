@@ -0,0 +1,127 @@
+#ifndef _JSONDOCUMENT_H
+#define _JSONDOCUMENT_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+
+struct JsonMember;
+
+// A value of a JsonDocument, 16 bytes on 64 bit targets: a tag and a length, and a
+// pointer to the text of strings and numbers, or to the contiguous elements or members
+// of arrays and objects. Nodes are neither reference counted nor polymorphic.
+class JsonNode {
+public:
+    enum Kind { NullValue, FalseValue, TrueValue, NumberValue, StringValue, ArrayValue, ObjectValue };
+
+    Kind kind() const { return (Kind)tag; }
+    bool isNull() const { return tag == NullValue; }
+    bool isBoolean() const { return tag == FalseValue || tag == TrueValue; }
+    bool isTrue() const { return tag == TrueValue; }
+    bool isFalse() const { return tag == FalseValue; }
+    bool isNumber() const { return tag == NumberValue; }
+    bool isString() const { return tag == StringValue; }
+    bool isArray() const { return tag == ArrayValue; }
+    bool isObject() const { return tag == ObjectValue; }
+
+    // the number of elements or members, or the length of the text
+    int size() const { return len; }
+
+    // strings and numbers; the text is not NUL terminated
+    const char* text() const { return u.text; }
+    std::string toString() const { return std::string(u.text, len); }
+
+    // arrays
+    const JsonNode& at(int i) const { return u.elements[i]; }
+
+    // objects; get() returns the value of the first member with the given name or 0
+    inline const JsonMember& member(int i) const;
+    const JsonNode* get(const char* name) const;
+private:
+    friend class JsonDocument;
+    unsigned char tag;
+    int len;
+    union {
+        const char* text;
+        const JsonNode* elements;
+        const JsonMember* members;
+    } u;
+};
+
+struct JsonMember {
+    JsonNode name;
+    JsonNode value;
+};
+
+const JsonMember& JsonNode::member(int i) const
+{
+    return u.members[i];
+}
+
+// Parses JSON text into JsonNodes, which together with the unescaped strings live in
+// chunks owned by the document; instead of releasing the nodes one by one, the chunks
+// are reused when the document parses the next text and freed with the document.
+// Like with JsonParser, strings and numbers without escapes refer to the source text.
+class JsonDocument {
+public:
+    JsonDocument();
+    ~JsonDocument();
+
+    // Discards the nodes of the previous text and returns the root of the new one; data
+    // has to outlive the nodes. Errors are thrown as const char*.
+    const JsonNode& parse(const char* data, int size);
+    const JsonNode& root() const { return top; }
+    // number of nodes of the document, including the names of the members
+    int nodeCount() const;
+
+    // bytes of the chunks in use by the current document
+    size_t bytesUsed() const;
+private:
+    class Parser;
+    enum { CHUNK_SIZE = 64 * 1024 };
+    struct Chunk {
+        Chunk* next;
+        size_t size;    // usable bytes following the header
+        size_t used;
+    };
+    void* allocate(size_t size);
+    static JsonNode node(JsonNode::Kind kind, int len, const void* p) {
+        JsonNode n;
+        n.tag = kind;
+        n.len = len;
+        n.u.text = (const char*)p;
+        return n;
+    }
+
+    Chunk* chunks;
+    Chunk* current;
+    JsonNode top;
+    JsonNode* stack;    // of the parser, kept for the next text
+    int stackCapacity;
+
+    JsonDocument(const JsonDocument&);
+    JsonDocument& operator=(const JsonDocument&);
+};
+
+#endif // _JSONDOCUMENT_H
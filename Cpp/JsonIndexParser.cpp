@@ -0,0 +1,333 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JsonIndexParser.h"
+#include "JsonParser.h"
+#include <som/Interfaces.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_SSE2
+#endif
+
+namespace {
+
+// Bit i of each mask classifies byte i of a block
+struct Masks {
+    unsigned int quote;
+    unsigned int backslash;
+    unsigned int space;
+    unsigned int op;    // { } [ ] : ,
+};
+
+#if defined(JSON_AVX2)
+inline unsigned int eq(__m256i v, char c)
+{
+    return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+}
+
+inline void classify(const char* p, Masks& m)
+{
+    const __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    m.quote = eq(v, '"');
+    m.backslash = eq(v, '\\');
+    m.space = eq(v, ' ') | eq(v, '\t') | eq(v, '\n') | eq(v, '\r');
+    m.op = eq(v, '{') | eq(v, '}') | eq(v, '[') | eq(v, ']') | eq(v, ':') | eq(v, ',');
+}
+#elif defined(JSON_SSE2)
+inline unsigned int eq(__m128i v, char c)
+{
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+
+inline void classify(const char* p, Masks& m)
+{
+    m.quote = m.backslash = m.space = m.op = 0;
+    for( int i = 0; i < 32; i += 16 )
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        m.quote |= eq(v, '"') << i;
+        m.backslash |= eq(v, '\\') << i;
+        m.space |= (eq(v, ' ') | eq(v, '\t') | eq(v, '\n') | eq(v, '\r')) << i;
+        m.op |= (eq(v, '{') | eq(v, '}') | eq(v, '[') | eq(v, ']') | eq(v, ':') | eq(v, ',')) << i;
+    }
+}
+#else
+inline void classify(const char* p, Masks& m)
+{
+    m.quote = m.backslash = m.space = m.op = 0;
+    for( int i = 0; i < 32; i++ )
+    {
+        const unsigned int bit = 1u << i;
+        switch( p[i] )
+        {
+        case '"':
+            m.quote |= bit;
+            break;
+        case '\\':
+            m.backslash |= bit;
+            break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            m.space |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+            m.op |= bit;
+            break;
+        }
+    }
+}
+#endif
+
+// bit i of the result is the xor of the bits 0..i of x
+inline unsigned int prefixXor(unsigned int x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    return x;
+}
+
+inline bool isSpace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+}
+
+JsonIndexParser::JsonIndexParser(const char* data, int size):data(data),size(size),token(0)
+{
+    // at most every byte starts a token, plus the terminator
+    tokens = (int*)Allocator::allocate((size + 1) * sizeof(int));
+    NULL_ = new JsonLiteral("null");
+    TRUE = new JsonLiteral("true");
+    FALSE = new JsonLiteral("false");
+}
+
+JsonIndexParser::~JsonIndexParser()
+{
+    Allocator::deallocate(tokens);
+}
+
+Ref<JsonValue> JsonIndexParser::parse()
+{
+    buildIndex();
+    token = 0;
+    Ref<JsonValue> result = readValue();
+    if( tokens[token] != size )
+        throw "Unexpected character";
+    return result;
+}
+
+void JsonIndexParser::buildIndex()
+{
+    unsigned int escapeCarry = 0;   // 1 if the previous block ended with an escaping backslash
+    unsigned int stringCarry = 0;   // all ones if the previous block ended inside a string
+    unsigned int scalarCarry = 0;   // 1 if the previous block ended inside a number or literal
+    char tail[BLOCK];
+    int n = 0;
+    for( int base = 0; base < size; base += BLOCK )
+    {
+        const char* p = data + base;
+        if( size - base < BLOCK )
+        {
+            memset(tail, ' ', BLOCK);
+            memcpy(tail, p, size - base);
+            p = tail;
+        }
+        Masks m;
+        classify(p, m);
+
+        // A backslash escapes the next byte unless it is escaped itself; backslashes
+        // are rare, so the runs are resolved one backslash at a time.
+        unsigned int escaped = escapeCarry;
+        unsigned int backslash = m.backslash & ~escapeCarry;
+        escapeCarry = 0;
+        while( backslash )
+        {
+            const int i = som::lowestBit(backslash);
+            if( i == BLOCK - 1 )
+            {
+                escapeCarry = 1;
+                break;
+            }
+            escaped |= 2u << i;
+            backslash &= ~(3u << i);
+        }
+
+        // inString covers the opening quote and the contents, but not the closing quote
+        const unsigned int quote = m.quote & ~escaped;
+        const unsigned int inString = prefixXor(quote) ^ stringCarry;
+        stringCarry = 0u - (inString >> (BLOCK - 1));
+
+        const unsigned int scalar = ~(m.op | m.space | quote | inString);
+        const unsigned int scalarStart = scalar & ~(scalar << 1 | scalarCarry);
+        scalarCarry = scalar >> (BLOCK - 1);
+
+        unsigned int bits = (m.op & ~inString) | quote | scalarStart;
+        while( bits )
+        {
+            tokens[n++] = base + som::lowestBit(bits);
+            bits &= bits - 1;
+        }
+    }
+    if( stringCarry )
+        throw "unterminated string";
+    tokens[n] = size;
+}
+
+Ref<JsonValue> JsonIndexParser::readValue()
+{
+    switch( next() )
+    {
+    case 'n':
+        return readScalar("null", NULL_);
+    case 't':
+        return readScalar("true", TRUE);
+    case 'f':
+        return readScalar("false", FALSE);
+    case '"':
+        return new JsonString(readText());
+    case '[':
+        return readArray().ptr();
+    case '{':
+        return readObject().ptr();
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return readScalar(0, 0);
+    default:
+        throw "expected value";
+    }
+}
+
+Ref<JsonArray> JsonIndexParser::readArray()
+{
+    token++;
+    Ref<JsonArray> array = new JsonArray();
+    if( next() == ']' )
+    {
+        token++;
+        return array;
+    }
+    while( true )
+    {
+        array->add(readValue());
+        const char ch = next();
+        token++;
+        if( ch == ']' )
+            return array;
+        if( ch != ',' )
+            throw "expected ',' or ']'";
+    }
+}
+
+Ref<JsonObject> JsonIndexParser::readObject()
+{
+    token++;
+    Ref<JsonObject> object = new JsonObject();
+    if( next() == '}' )
+    {
+        token++;
+        return object;
+    }
+    while( true )
+    {
+        if( next() != '"' )
+            throw "expected name";
+        const JsonText name = readText();
+        if( next() != ':' )
+            throw "expected ':'";
+        token++;
+        object->add(name, readValue());
+        const char ch = next();
+        token++;
+        if( ch == '}' )
+            return object;
+        if( ch != ',' )
+            throw "expected ',' or '}'";
+    }
+}
+
+// a number if literal is null
+Ref<JsonValue> JsonIndexParser::readScalar(const char* literal, JsonValue* value)
+{
+    const char* start = data + tokens[token++];
+    const char* end = data + size;
+    Ref<JsonValue> result = value;
+    int len;
+    if( literal )
+    {
+        len = strlen(literal);
+        if( end - start < len || memcmp(start, literal, len) != 0 )
+            throw "expected literal";
+    }else
+    {
+        len = JsonParser::scanNumber(start, end);
+        if( len < 0 )
+            throw "expected digit";
+        result = new JsonNumber(JsonText(start, len));
+    }
+    expectScalarEnd(start - data + len);
+    return result;
+}
+
+JsonText JsonIndexParser::readText()
+{
+    // the opening quote is followed by the closing quote in the index
+    const int from = tokens[token] + 1;
+    const int to = tokens[token + 1];
+    if( to == size )
+        throw "unterminated string";
+    token += 2;
+    if( memchr(data + from, '\\', to - from) == 0 )
+        return JsonText(data + from, to - from);
+    JsonParser::unescape(data + from, data + to, unescaped);
+    return JsonText::copy(unescaped.data(), unescaped.size());
+}
+
+void JsonIndexParser::expectScalarEnd(int end)
+{
+    // only whitespace may be between a number or literal and the next token
+    while( end < tokens[token] && isSpace(data[end]) )
+        end++;
+    if( end != tokens[token] )
+        throw "Unexpected character";
+}
@@ -0,0 +1,61 @@
+#ifndef _JSONINDEXPARSER_H
+#define _JSONINDEXPARSER_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JsonValue.h"
+
+// Two stage parser. The first stage classifies the input in blocks of 32 bytes (using
+// AVX2 or SSE2 where available) into bit masks of quotes, backslashes, whitespace and
+// structural characters, and derives from them the index of the positions where tokens
+// start: the structural characters and the quotes outside of strings, and the first
+// characters of numbers and literals. The second stage builds the document from the
+// index, without looking at the characters in between. Like JsonParser, strings and
+// numbers refer to the source buffer. Errors are thrown as const char*.
+class JsonIndexParser {
+public:
+    JsonIndexParser(const char* data, int size);
+    ~JsonIndexParser();
+    Ref<JsonValue> parse();
+private:
+    enum { BLOCK = 32 };
+    void buildIndex();
+    Ref<JsonValue> readValue();
+    Ref<JsonArray> readArray();
+    Ref<JsonObject> readObject();
+    Ref<JsonValue> readScalar(const char* literal, JsonValue* value);
+    JsonText readText();
+    void expectScalarEnd(int end);
+
+    char next() const { return tokens[token] < size ? data[tokens[token]] : 0; }
+
+    const char* data;
+    int size;
+    int* tokens;     // the index, terminated by size
+    int token;       // the current position in tokens
+    std::string unescaped;
+    Ref<JsonValue> NULL_;
+    Ref<JsonValue> TRUE;
+    Ref<JsonValue> FALSE;
+};
+
+#endif // _JSONINDEXPARSER_H
@@ -0,0 +1,317 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JsonParser.h"
+
+JsonParser::JsonParser(const char* data, int size):pos(data),end(data + size)
+{
+    NULL_ = new JsonLiteral("null");
+    TRUE = new JsonLiteral("true");
+    FALSE = new JsonLiteral("false");
+}
+
+Ref<JsonValue> JsonParser::parse()
+{
+    skipWhiteSpace();
+    Ref<JsonValue> result = readValue();
+    skipWhiteSpace();
+    if( pos < end )
+        throw "Unexpected character";
+    return result;
+}
+
+Ref<JsonValue> JsonParser::readValue()
+{
+    switch( current() )
+    {
+    case 'n':
+        return readLiteral("null", NULL_);
+    case 't':
+        return readLiteral("true", TRUE);
+    case 'f':
+        return readLiteral("false", FALSE);
+    case '"':
+        return new JsonString(readText());
+    case '[':
+        return readArray().ptr();
+    case '{':
+        return readObject().ptr();
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return readNumber();
+    default:
+        throw "expected value";
+    }
+}
+
+Ref<JsonArray> JsonParser::readArray()
+{
+    pos++;
+    Ref<JsonArray> array = new JsonArray();
+    skipWhiteSpace();
+    if( readChar(']') )
+        return array;
+    do
+    {
+        skipWhiteSpace();
+        array->add(readValue());
+        skipWhiteSpace();
+    } while( readChar(',') );
+    if( !readChar(']') )
+        throw "expected ',' or ']'";
+    return array;
+}
+
+Ref<JsonObject> JsonParser::readObject()
+{
+    pos++;
+    Ref<JsonObject> object = new JsonObject();
+    skipWhiteSpace();
+    if( readChar('}') )
+        return object;
+    do
+    {
+        skipWhiteSpace();
+        if( current() != '"' )
+            throw "expected name";
+        const JsonText name = readText();
+        skipWhiteSpace();
+        if( !readChar(':') )
+            throw "expected ':'";
+        skipWhiteSpace();
+        object->add(name, readValue());
+        skipWhiteSpace();
+    } while( readChar(',') );
+    if( !readChar('}') )
+        throw "expected ',' or '}'";
+    return object;
+}
+
+Ref<JsonValue> JsonParser::readLiteral(const char* literal, JsonValue* value)
+{
+    const int len = strlen(literal);
+    if( end - pos < len || memcmp(pos, literal, len) != 0 )
+        throw "expected literal";
+    pos += len;
+    return value;
+}
+
+Ref<JsonValue> JsonParser::readNumber()
+{
+    const int len = scanNumber(pos, end);
+    if( len < 0 )
+        throw "expected digit";
+    pos += len;
+    return new JsonNumber(JsonText(pos - len, len));
+}
+
+JsonText JsonParser::readText()
+{
+    pos++;
+    const char* start = pos;
+    while( pos < end && *pos != '"' && *pos != '\\' )
+        pos++;
+    if( pos == end )
+        throw "unterminated string";
+    if( *pos == '"' )
+    {
+        // the common case, no copy
+        pos++;
+        return JsonText(start, pos - 1 - start);
+    }
+    while( pos < end && *pos != '"' )
+        pos += *pos == '\\' ? 2 : 1;
+    if( pos >= end )
+        throw "unterminated string";
+    pos++;
+    unescape(start, pos - 1, unescaped);
+    return JsonText::copy(unescaped.data(), unescaped.size());
+}
+
+static inline bool isDigit(const char* p, const char* end)
+{
+    return p < end && *p >= '0' && *p <= '9';
+}
+
+int JsonParser::scanNumber(const char* start, const char* end)
+{
+    const char* p = start;
+    if( p < end && *p == '-' )
+        p++;
+    if( !isDigit(p, end) )
+        return -1;
+    if( *p++ != '0' )
+        while( isDigit(p, end) )
+            p++;
+    if( p < end && *p == '.' )
+    {
+        p++;
+        if( !isDigit(p, end) )
+            return -1;
+        while( isDigit(p, end) )
+            p++;
+    }
+    if( p < end && (*p == 'e' || *p == 'E') )
+    {
+        p++;
+        if( p < end && (*p == '+' || *p == '-') )
+            p++;
+        if( !isDigit(p, end) )
+            return -1;
+        while( isDigit(p, end) )
+            p++;
+    }
+    return p - start;
+}
+
+static int readHex(const char*& p, const char* end)
+{
+    if( end - p < 4 )
+        throw "expected four hex digits";
+    int code = 0;
+    for( int i = 0; i < 4; i++ )
+    {
+        const char ch = *p++;
+        code <<= 4;
+        if( ch >= '0' && ch <= '9' )
+            code |= ch - '0';
+        else if( ch >= 'a' && ch <= 'f' )
+            code |= ch - 'a' + 10;
+        else if( ch >= 'A' && ch <= 'F' )
+            code |= ch - 'A' + 10;
+        else
+            throw "expected four hex digits";
+    }
+    return code;
+}
+
+void JsonParser::appendUtf8(std::string& out, unsigned int code)
+{
+    if( code < 0x80 )
+        out += (char)code;
+    else if( code < 0x800 )
+    {
+        out += (char)(0xc0 | (code >> 6));
+        out += (char)(0x80 | (code & 0x3f));
+    }else if( code < 0x10000 )
+    {
+        out += (char)(0xe0 | (code >> 12));
+        out += (char)(0x80 | ((code >> 6) & 0x3f));
+        out += (char)(0x80 | (code & 0x3f));
+    }else
+    {
+        out += (char)(0xf0 | (code >> 18));
+        out += (char)(0x80 | ((code >> 12) & 0x3f));
+        out += (char)(0x80 | ((code >> 6) & 0x3f));
+        out += (char)(0x80 | (code & 0x3f));
+    }
+}
+
+// p points behind the backslash
+static void readEscape(const char*& p, const char* end, std::string& out)
+{
+    if( p == end )
+        throw "expected valid escape sequence";
+    const char ch = *p++;
+    switch( ch )
+    {
+    case '"':
+    case '/':
+    case '\\':
+        out += ch;
+        break;
+    case 'b':
+        out += '\b';
+        break;
+    case 'f':
+        out += '\f';
+        break;
+    case 'n':
+        out += '\n';
+        break;
+    case 'r':
+        out += '\r';
+        break;
+    case 't':
+        out += '\t';
+        break;
+    case 'u':
+        {
+            unsigned int code = readHex(p, end);
+            if( code >= 0xd800 && code < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u' )
+            {
+                // surrogate pair
+                const char* save = p;
+                p += 2;
+                const unsigned int low = readHex(p, end);
+                if( low >= 0xdc00 && low < 0xe000 )
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                else
+                    p = save;
+            }
+            JsonParser::appendUtf8(out, code);
+        }
+        break;
+    default:
+        throw "expected valid escape sequence";
+    }
+}
+
+void JsonParser::unescape(const char* from, const char* to, std::string& buffer)
+{
+    buffer.clear();
+    const char* p = from;
+    while( p < to )
+    {
+        const char* bs = (const char*)memchr(p, '\\', to - p);
+        if( bs == 0 )
+        {
+            buffer.append(p, to - p);
+            break;
+        }
+        buffer.append(p, bs - p);
+        p = bs + 1;
+        readEscape(p, to, buffer);
+    }
+}
+
+bool JsonParser::readChar(char ch)
+{
+    if( pos == end || *pos != ch )
+        return false;
+    pos++;
+    return true;
+}
+
+void JsonParser::skipWhiteSpace()
+{
+    while( pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r') )
+        pos++;
+}
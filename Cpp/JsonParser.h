@@ -0,0 +1,65 @@
+#ifndef _JSONPARSER_H
+#define _JSONPARSER_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JsonValue.h"
+
+// Benchmark variant switch: if defined, Json uses the original JsonPureStringParser
+// instead of JsonParser
+// #define JSON_PURE_STRING_PARSER
+
+// Parses JSON text in place: the strings and numbers of the resulting document refer to
+// the source buffer, which therefore has to outlive the document; only strings with
+// escapes are unescaped into a copy. Accepts the grammar of JsonPureStringParser and in
+// addition \u escapes, which are converted to UTF-8. Errors are thrown as const char*.
+class JsonParser {
+public:
+    JsonParser(const char* data, int size);
+    Ref<JsonValue> parse();
+
+    // Length of the number starting at p, or -1 if there is none.
+    static int scanNumber(const char* p, const char* end);
+    // Unescapes the string contents [from, to) into buffer.
+    static void unescape(const char* from, const char* to, std::string& buffer);
+    static void appendUtf8(std::string& out, unsigned int code);
+private:
+    Ref<JsonValue> readValue();
+    Ref<JsonArray> readArray();
+    Ref<JsonObject> readObject();
+    Ref<JsonValue> readLiteral(const char* literal, JsonValue* value);
+    Ref<JsonValue> readNumber();
+    JsonText readText();
+    bool readChar(char ch);
+    void skipWhiteSpace();
+
+    char current() const { return pos < end ? *pos : 0; }
+
+    const char* pos;
+    const char* end;
+    std::string unescaped;
+    Ref<JsonValue> NULL_;
+    Ref<JsonValue> TRUE;
+    Ref<JsonValue> FALSE;
+};
+
+#endif // _JSONPARSER_H
@@ -0,0 +1,377 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JsonReader.h"
+#include "JsonParser.h"
+#include "Allocator.h"
+#include <string.h>
+#include <errno.h>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+int JsonReader::FileSource::read(char* buffer, int size)
+{
+    while( true )
+    {
+#if defined(_WIN32)
+        const int n = ::_read(fd, buffer, size);
+#else
+        const int n = ::read(fd, buffer, size);
+#endif
+        if( n >= 0 )
+            return n;
+        if( errno != EINTR )
+            throw "cannot read input";
+    }
+}
+
+int JsonReader::MemorySource::read(char* buffer, int max)
+{
+    int n = size < chunkSize ? size : chunkSize;
+    if( n > max )
+        n = max;
+    memcpy(buffer, data, n);
+    data += n;
+    size -= n;
+    return n;
+}
+
+JsonReader::JsonReader(Source* source, int bufferSize):source(source),bufferSize(bufferSize),
+    consumed(0),eof(false),state(Value),textPtr(""),textLen(0)
+{
+    buffer = (char*)Allocator::allocate(bufferSize);
+    pos = end = buffer;
+}
+
+JsonReader::~JsonReader()
+{
+    Allocator::deallocate(buffer);
+}
+
+int JsonReader::memoryUsed() const
+{
+    return bufferSize + token.capacity() + containers.capacity();
+}
+
+JsonReader::Event JsonReader::next()
+{
+    skipWhiteSpace();
+    switch( state )
+    {
+    case Value:
+        return readValue();
+    case FirstInArray:
+        if( readChar(']') )
+            return endContainer();
+        return readValue();
+    case FirstInObject:
+        if( readChar('}') )
+            return endContainer();
+        return readKey();
+    case Colon:
+        if( !readChar(':') )
+            throw "expected ':'";
+        skipWhiteSpace();
+        return readValue();
+    case AfterValue:
+        {
+            const bool object = containers.at(containers.size() - 1) == '{';
+            if( readChar(object ? '}' : ']') )
+                return endContainer();
+            if( !readChar(',') )
+                throw object ? "expected ',' or '}'" : "expected ',' or ']'";
+            skipWhiteSpace();
+            return object ? readKey() : readValue();
+        }
+    case Done:
+        if( peek() != 0 || pos != end )
+            throw "Unexpected character";
+        return End;
+    }
+    return End;
+}
+
+JsonReader::Event JsonReader::readValue()
+{
+    switch( peek() )
+    {
+    case '{':
+        pos++;
+        containers.append('{');
+        state = FirstInObject;
+        return StartObject;
+    case '[':
+        pos++;
+        containers.append('[');
+        state = FirstInArray;
+        return StartArray;
+    case '"':
+        readString();
+        afterValue();
+        return String;
+    case 't':
+    case 'f':
+    case 'n':
+        readScalar(false);
+        afterValue();
+        if( textLen == 4 && memcmp(textPtr, "true", 4) == 0 )
+            return True;
+        if( textLen == 5 && memcmp(textPtr, "false", 5) == 0 )
+            return False;
+        if( textLen == 4 && memcmp(textPtr, "null", 4) == 0 )
+            return Null;
+        throw "expected literal";
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        readScalar(true);
+        if( JsonParser::scanNumber(textPtr, textPtr + textLen) != textLen )
+            throw "expected digit";
+        afterValue();
+        return Number;
+    default:
+        throw "expected value";
+    }
+}
+
+JsonReader::Event JsonReader::readKey()
+{
+    if( peek() != '"' )
+        throw "expected name";
+    readString();
+    // the colon is read by the next call, which may refill the buffer holding the name
+    state = Colon;
+    return Key;
+}
+
+JsonReader::Event JsonReader::endContainer()
+{
+    const char c = containers.removeLast();
+    afterValue();
+    return c == '{' ? EndObject : EndArray;
+}
+
+void JsonReader::afterValue()
+{
+    state = containers.isEmpty() ? Done : AfterValue;
+}
+
+void JsonReader::readString()
+{
+    pos++;
+    const char* start = pos;
+    bool copied = false;
+    while( true )
+    {
+        while( pos < end && *pos != '"' && *pos != '\\' )
+            pos++;
+        if( pos < end && *pos == '"' && !copied )
+        {
+            // the common case, no copy
+            textPtr = start;
+            textLen = pos - start;
+            pos++;
+            return;
+        }
+        if( !copied )
+        {
+            token.clear();
+            copied = true;
+        }
+        token.append(start, pos - start);
+        if( pos == end )
+        {
+            if( !fill() )
+                throw "unterminated string";
+        }else if( *pos == '"' )
+        {
+            pos++;
+            break;
+        }else
+        {
+            pos++;
+            readEscape();
+        }
+        start = pos;
+    }
+    textPtr = token.data();
+    textLen = token.size();
+}
+
+void JsonReader::readEscape()
+{
+    const char ch = get();
+    switch( ch )
+    {
+    case '"':
+    case '/':
+    case '\\':
+        token += ch;
+        break;
+    case 'b':
+        token += '\b';
+        break;
+    case 'f':
+        token += '\f';
+        break;
+    case 'n':
+        token += '\n';
+        break;
+    case 'r':
+        token += '\r';
+        break;
+    case 't':
+        token += '\t';
+        break;
+    case 'u':
+        {
+            const unsigned int code = readHex();
+            if( code >= 0xd800 && code < 0xdc00 && peek() == '\\' )
+            {
+                // a surrogate pair if followed by a low surrogate
+                pos++;
+                if( peek() != 'u' )
+                {
+                    JsonParser::appendUtf8(token, code);
+                    readEscape();
+                    break;
+                }
+                pos++;
+                const unsigned int low = readHex();
+                if( low >= 0xdc00 && low < 0xe000 )
+                    JsonParser::appendUtf8(token, 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00));
+                else
+                {
+                    JsonParser::appendUtf8(token, code);
+                    JsonParser::appendUtf8(token, low);
+                }
+            }else
+                JsonParser::appendUtf8(token, code);
+        }
+        break;
+    default:
+        throw "expected valid escape sequence";
+    }
+}
+
+int JsonReader::readHex()
+{
+    int code = 0;
+    for( int i = 0; i < 4; i++ )
+    {
+        const char ch = get();
+        code <<= 4;
+        if( ch >= '0' && ch <= '9' )
+            code |= ch - '0';
+        else if( ch >= 'a' && ch <= 'f' )
+            code |= ch - 'a' + 10;
+        else if( ch >= 'A' && ch <= 'F' )
+            code |= ch - 'A' + 10;
+        else
+            throw "expected four hex digits";
+    }
+    return code;
+}
+
+static inline bool isScalarChar(char ch, bool number)
+{
+    if( number )
+        return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+    return ch >= 'a' && ch <= 'z';
+}
+
+// reads the characters of a number or literal, which are checked by the caller
+void JsonReader::readScalar(bool number)
+{
+    const char* start = pos;
+    bool copied = false;
+    while( true )
+    {
+        while( pos < end && isScalarChar(*pos, number) )
+            pos++;
+        if( pos < end )
+            break;
+        // the token may continue in the next buffer
+        if( !copied )
+        {
+            token.clear();
+            copied = true;
+        }
+        token.append(start, pos - start);
+        const bool more = fill();
+        start = pos;
+        if( !more )
+            break;
+    }
+    if( copied )
+    {
+        token.append(start, pos - start);
+        textPtr = token.data();
+        textLen = token.size();
+    }else
+    {
+        textPtr = start;
+        textLen = pos - start;
+    }
+}
+
+bool JsonReader::readChar(char ch)
+{
+    if( peek() != ch )
+        return false;
+    pos++;
+    return true;
+}
+
+void JsonReader::skipWhiteSpace()
+{
+    while( true )
+    {
+        while( pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r') )
+            pos++;
+        if( pos < end || !fill() )
+            return;
+    }
+}
+
+bool JsonReader::fill()
+{
+    if( eof )
+        return false;
+    consumed += end - buffer;
+    const int n = source->read(buffer, bufferSize);
+    pos = buffer;
+    end = buffer + (n > 0 ? n : 0);
+    if( n <= 0 )
+        eof = true;
+    return n > 0;
+}
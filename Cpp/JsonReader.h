@@ -0,0 +1,121 @@
+#ifndef _JSONREADER_H
+#define _JSONREADER_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <som/Vector.h>
+#include <string>
+
+// Pull parser with the grammar of JsonPureStringParser which reads its input in chunks
+// from a Source and reports the document as a sequence of events instead of building it;
+// its memory is bounded by the buffer size, the longest string or number which crosses a
+// buffer boundary or has escapes, and the nesting depth.
+class JsonReader {
+public:
+    enum Event { StartObject, EndObject, StartArray, EndArray, Key, String, Number,
+                 True, False, Null, End };
+
+    class Source {
+    public:
+        virtual ~Source() {}
+        // copies up to size bytes to buffer and returns their number, 0 at the end
+        virtual int read(char* buffer, int size) = 0;
+    };
+
+    // reads from a file descriptor, which is not closed
+    class FileSource : public Source {
+    public:
+        FileSource(int fd):fd(fd) {}
+        int read(char* buffer, int size);
+    private:
+        int fd;
+    };
+
+    // hands out a memory block in chunks of at most chunkSize bytes
+    class MemorySource : public Source {
+    public:
+        MemorySource(const char* data, int size, int chunkSize):data(data),size(size),chunkSize(chunkSize) {}
+        int read(char* buffer, int size);
+    private:
+        const char* data;
+        int size;
+        int chunkSize;
+    };
+
+    enum { DEFAULT_BUFFER = 64 * 1024 };
+    JsonReader(Source* source, int bufferSize = DEFAULT_BUFFER);
+    ~JsonReader();
+
+    // Returns End after the top level value; errors are thrown as const char*.
+    Event next();
+
+    // The name of Key, the unescaped contents of String and the text of Number events;
+    // valid until the next call of next(), not NUL terminated.
+    const char* text() const { return textPtr; }
+    int textSize() const { return textLen; }
+    std::string toString() const { return std::string(textPtr, textLen); }
+
+    // number of open arrays and objects
+    int depth() const { return containers.size(); }
+    long long bytesRead() const { return consumed + (pos - buffer); }
+    // bytes currently held by the reader
+    int memoryUsed() const;
+private:
+    enum State { Value, FirstInArray, FirstInObject, Colon, AfterValue, Done };
+    Event readValue();
+    Event readKey();
+    Event endContainer();
+    void afterValue();
+    void readString();
+    void readEscape();
+    int readHex();
+    void readScalar(bool number);
+    bool readChar(char ch);
+    void skipWhiteSpace();
+    bool fill();
+
+    char peek() {
+        if( pos == end && !fill() )
+            return 0;
+        return *pos;
+    }
+    char get() {
+        if( pos == end && !fill() )
+            return 0;
+        return *pos++;
+    }
+
+    Source* source;
+    char* buffer;
+    int bufferSize;
+    const char* pos;
+    const char* end;
+    long long consumed;     // bytes of the buffers before the current one
+    bool eof;
+    State state;
+    som::Vector<char> containers;   // '{' or '[' of the open containers
+    std::string token;      // a string or number which had to be copied
+    const char* textPtr;
+    int textLen;
+};
+
+#endif // _JSONREADER_H
@@ -0,0 +1,364 @@
+#ifndef _JSONVALUE_H
+#define _JSONVALUE_H
+
+/*******************************************************************************
+ * Copyright (c) 2023 Rochus Keller <me@rochus-keller.ch> (for C++ migration)
+ * Copyright (c) 2015 Stefan Marr
+ * Copyright (c) 2013, 2015 EclipseSource.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#include "Object.h"
+#include "som/Vector.h"
+#include <string>
+#include <string.h>
+
+// The document model of the Json benchmark, shared by its parsers.
+
+class JsonObject;
+class JsonArray;
+
+// A string of the JSON text; it refers to the characters in the source buffer, which
+// therefore has to outlive the document, unless it had to be unescaped or was created
+// from a std::string, in which case it owns a copy allocated by the current Allocator.
+class JsonText {
+    const char* ptr;
+    int len;
+    bool owner;
+
+    void assign(const char* p, int n, bool copy) {
+        len = n;
+        owner = copy;
+        if (copy) {
+            char* c = (char*)Allocator::allocate(n + 1);
+            memcpy(c, p, n);
+            c[n] = 0;
+            ptr = c;
+        } else {
+            ptr = p;
+        }
+    }
+public:
+    JsonText():ptr(""),len(0),owner(false) {}
+    JsonText(const char* p, int n):ptr(p),len(n),owner(false) {}
+    explicit JsonText(const std::string& s) {
+        assign(s.data(), s.size(), true);
+    }
+    JsonText(const JsonText& rhs) {
+        assign(rhs.ptr, rhs.len, rhs.owner);
+    }
+    ~JsonText() {
+        if (owner) {
+            Allocator::deallocate((void*)ptr);
+        }
+    }
+    JsonText& operator=(const JsonText& rhs) {
+        if (this != &rhs) {
+            this->~JsonText();
+            assign(rhs.ptr, rhs.len, rhs.owner);
+        }
+        return *this;
+    }
+
+    // a copy which doesn't depend on the source buffer
+    static JsonText copy(const char* p, int n) {
+        JsonText t;
+        t.assign(p, n, true);
+        return t;
+    }
+
+    const char* data() const { return ptr; }
+    int size() const { return len; }
+    bool empty() const { return len == 0; }
+    std::string toString() const { return std::string(ptr, len); }
+
+    bool operator==(const JsonText& rhs) const {
+        return len == rhs.len && memcmp(ptr, rhs.ptr, len) == 0;
+    }
+    bool operator==(const std::string& rhs) const {
+        return len == (int)rhs.size() && memcmp(ptr, rhs.data(), len) == 0;
+    }
+};
+
+namespace som {
+SOM_RELOCATABLE(JsonText)
+}
+
+class JsonValue : public Object{
+public:
+    virtual bool isObject() {
+        return false;
+    }
+
+    virtual bool isArray() {
+        return false;
+    }
+
+    virtual bool isNumber() {
+        return false;
+    }
+
+    virtual bool isString() {
+        return false;
+    }
+
+    virtual bool isBoolean() {
+        return false;
+    }
+
+    virtual bool isTrue() {
+        return false;
+    }
+
+    virtual bool isFalse() {
+        return false;
+    }
+
+    virtual bool isNull() {
+        return false;
+    }
+
+    virtual JsonObject* asObject() {
+        throw "Not an object";
+    }
+
+    virtual JsonArray* asArray() {
+        throw "Not an array";
+    }
+};
+
+class JsonObject : public JsonValue {
+
+    som::Vector<JsonText> names;
+    som::Vector< Ref<JsonValue> > values;
+
+
+    class HashIndexTable {
+
+        int* hashTable;
+        int len;
+    public:
+        HashIndexTable() {
+            len = 32;
+            hashTable = new int[len]; // must be a power of two
+        }
+        ~HashIndexTable()
+        {
+            delete[] hashTable;
+        }
+
+        void add(const JsonText& name, int index) {
+            int slot = hashSlotFor(name);
+            if (index < 0xff) {
+                // increment by 1, 0 stands for empty
+                hashTable[slot] = (index + 1) & 0xff;
+            } else {
+                hashTable[slot] = 0;
+            }
+        }
+
+        int get(const JsonText& name) {
+            int slot = hashSlotFor(name);
+            // subtract 1, 0 stands for empty
+            return (hashTable[slot] & 0xff) - 1;
+        }
+
+    private:
+        int stringHash(const JsonText& s) {
+            // this is not a proper hash, but sufficient for the benchmark,
+            // and very portable!
+            return s.size() * 1402589;
+        }
+
+        int hashSlotFor(const JsonText& element) {
+            return stringHash(element) & (len - 1);
+        }
+    };
+    HashIndexTable table;
+
+public:
+    JsonObject* add(const std::string& name, JsonValue* value) {
+        return add(JsonText(name), value);
+    }
+
+    JsonObject* add(const JsonText& name, JsonValue* value) {
+        if (name.empty()) {
+            throw "name is null";
+        }
+        if (value == 0) {
+            throw "value is null";
+        }
+        table.add(name, names.size());
+        names.append(name);
+        values.append(value);
+        return this;
+    }
+
+    JsonValue* get(const std::string& name) {
+        if (name.empty()) {
+            throw "name is null";
+        }
+        const int index = indexOf(JsonText(name.data(), name.size()));
+        return index == -1 ? 0 : values.at(index);
+    }
+
+    int size() {
+        return names.size();
+    }
+
+    bool isEmpty() {
+        return names.isEmpty();
+    }
+
+    bool isObject() {
+        return true;
+    }
+
+    JsonObject* asObject() {
+        return this;
+    }
+
+private:
+    int indexOf(const JsonText& name) {
+        int index = table.get(name);
+        if (index != -1 && name == names.at(index)) {
+            return index;
+        }
+        throw "Not needed for benchmark";
+    }
+};
+
+class JsonArray : public JsonValue {
+
+    som::Vector< Ref<JsonValue> > values;
+
+public:
+    JsonArray* add(JsonValue* value) {
+        if (value == 0) {
+            throw "value is null";
+        }
+        values.append(value);
+        return this;
+    }
+
+    int size() {
+        return values.size();
+    }
+
+    JsonValue* get(int index) {
+        return values.at(index);
+    }
+
+    bool isArray() {
+        return true;
+    }
+
+    JsonArray* asArray() {
+        return this;
+    }
+};
+
+
+class JsonString : public JsonValue {
+
+    JsonText string;
+
+public:
+    JsonString(const std::string& string):string(string) {}
+
+    JsonString(const JsonText& string):string(string) {}
+
+    const JsonText& text() const {
+        return string;
+    }
+
+    bool isString() {
+        return true;
+    }
+};
+
+class JsonNumber : public JsonValue {
+
+    JsonText string;
+
+public:
+    JsonNumber(const std::string& string):string(string) {
+        if (string.empty()) {
+            throw "string is null";
+        }
+    }
+
+    JsonNumber(const JsonText& string):string(string) {
+        if (string.empty()) {
+            throw "string is null";
+        }
+    }
+
+    std::string toString() const {
+        return string.toString();
+    }
+
+    const JsonText& text() const {
+        return string;
+    }
+
+    bool isNumber() {
+        return true;
+    }
+};
+
+class JsonLiteral : public JsonValue {
+
+
+    std::string value;
+    bool isNull_;
+    bool isTrue_;
+    bool isFalse_;
+
+public:
+    JsonLiteral(const std::string& value) {
+        this->value = value;
+        isNull_  = value == "null";
+        isTrue_  = value == "true";
+        isFalse_ = value == "false";
+    }
+
+    const std::string& toString() {
+        return value;
+    }
+
+    bool isNull() {
+        return isNull_;
+    }
+
+    bool isTrue() {
+        return isTrue_;
+    }
+
+    bool isFalse() {
+        return isFalse_;
+    }
+
+    bool isBoolean() {
+        return isTrue_ || isFalse_;
+    }
+};
+
+#endif // _JSONVALUE_H
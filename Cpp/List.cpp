@@ -22,6 +22,7 @@
  */
 
 #include "List.h"
+#include "Registry.h"
 #include "Object.h"
 
 // NOTE:
@@ -100,3 +101,5 @@ int List::benchmark()
     const int res = result->length();
     return res;
 }
+
+static Registration<List> registration("List", Registry::Micro, 1500, 1);
@@ -43,6 +43,7 @@
 */
 
 #include "Mandelbrot.h"
+#include "Registry.h"
 #include <iostream>
 
 bool Mandelbrot::verifyResult(int result, int innerIterations)
@@ -122,3 +123,6 @@ int Mandelbrot::mandelbrot(int size)
     }
     return sum;
 }
+
+static const int verifiedInnerIterations[] = { 500, 750, 1, 0 };
+static Registration<Mandelbrot> registration("Mandelbrot", Registry::Micro, 500, 1, verifiedInnerIterations);
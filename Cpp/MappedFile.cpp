@@ -0,0 +1,109 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "MappedFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile():ptr(0),len(0),mapped(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& path, std::string& error)
+{
+    close();
+#if !defined(_WIN32)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if( fd < 0 )
+    {
+        error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 )
+    {
+        void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if( p != MAP_FAILED )
+        {
+#if defined(MADV_SEQUENTIAL)
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+#endif
+            ::close(fd);
+            ptr = (const char*)p;
+            len = st.st_size;
+            mapped = true;
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+    // not mappable, e.g. empty, a pipe or on Windows
+    FILE* f = fopen(path.c_str(), "rb");
+    if( f == 0 )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string buf;
+    char chunk[64 * 1024];
+    size_t n;
+    while( (n = fread(chunk, 1, sizeof(chunk), f)) > 0 )
+        buf.append(chunk, n);
+    const bool ok = !ferror(f);
+    fclose(f);
+    if( !ok )
+    {
+        error = "cannot read " + path;
+        return false;
+    }
+    char* p = new char[buf.size() + 1];
+    memcpy(p, buf.data(), buf.size());
+    ptr = p;
+    len = buf.size();
+    return true;
+}
+
+void MappedFile::close()
+{
+    if( ptr == 0 )
+        return;
+#if !defined(_WIN32)
+    if( mapped )
+        munmap((void*)ptr, len);
+    else
+#endif
+        delete[] ptr;
+    ptr = 0;
+    len = 0;
+    mapped = false;
+}
@@ -6,6 +6,7 @@
  */
 
 #include "NBody.h"
+#include "Registry.h"
 #include <iostream>
 #include <math.h>
 #include <stdlib.h>
@@ -219,3 +220,6 @@ bool NBody::verifyResult(double result, int innerIterations)
     // Checkstyle: resume
     return false;
 }
+
+static const int verifiedInnerIterations[] = { 250000, 1, 0 };
+static Registration<NBody> registration("NBody", Registry::Micro, 250000, 1, verifiedInnerIterations);
@@ -0,0 +1,216 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "NdJson.h"
+#include "JsonDocument.h"
+#include "Thread.h"
+#include <som/Random.h>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    const char* data;   // of the whole text, for the error offset
+    NdJson::Result result;
+};
+
+inline bool isBlank(const char* p, const char* end)
+{
+    while( p < end && (*p == ' ' || *p == '\t' || *p == '\r') )
+        p++;
+    return p == end;
+}
+
+void parseChunk(void* arg)
+{
+    Chunk* c = (Chunk*)arg;
+    JsonDocument doc;
+    const char* p = c->begin;
+    while( p < c->end )
+    {
+        const char* nl = (const char*)memchr(p, '\n', c->end - p);
+        const char* eol = nl ? nl : c->end;
+        if( !isBlank(p, eol) )
+        {
+            try
+            {
+                doc.parse(p, eol - p);
+            }catch( const char* error )
+            {
+                c->result.error = error;
+                c->result.errorOffset = p - c->data;
+                return;
+            }
+            c->result.documents++;
+            c->result.nodes += doc.nodeCount();
+        }
+        p = nl ? nl + 1 : c->end;
+    }
+}
+
+void appendInt(std::string& out, int i)
+{
+    char buf[16];
+    sprintf(buf, "%d", i);
+    out += buf;
+}
+
+// appends a record and returns its JsonDocument::nodeCount()
+int appendRecord(std::string& out, int id, som::Random& r)
+{
+    out += "{\"id\":";
+    appendInt(out, id);
+    out += ",\"user\":\"user";
+    appendInt(out, r.next());
+    out += "\",\"score\":";
+    appendInt(out, r.next() % 1000);
+    out += '.';
+    appendInt(out, r.next() % 100);
+    out += ",\"active\":";
+    out += r.next() % 2 ? "true" : "false";
+    out += ",\"tags\":[";
+    const int tags = r.next() % 6;
+    for( int i = 0; i < tags; i++ )
+    {
+        if( i )
+            out += ',';
+        out += "\"t";
+        appendInt(out, r.next() % 50);
+        out += '"';
+    }
+    out += "],\"geo\":{\"lat\":-";
+    appendInt(out, r.next() % 90);
+    out += '.';
+    appendInt(out, r.next());
+    out += ",\"lon\":";
+    appendInt(out, r.next() % 180);
+    out += '.';
+    appendInt(out, r.next());
+    out += "e0},\"note\":\"";
+    const int words = r.next() % 12;
+    for( int i = 0; i < words; i++ )
+    {
+        switch( r.next() % 8 )
+        {
+        case 0:
+            out += "\\\"quoted\\\" ";
+            break;
+        case 1:
+            out += "caf\\u00e9 ";
+            break;
+        case 2:
+            out += "line\\nbreak ";
+            break;
+        default:
+            out += "word ";
+            break;
+        }
+    }
+    out += "\",\"parent\":null}\n";
+    // the object, eight names and values, the tags and the two members of geo
+    return 1 + 2 * 8 + tags + 4;
+}
+
+}
+
+NdJson::Result NdJson::parse(const char* data, size_t size, ThreadPool* pool, size_t chunkSize)
+{
+    std::vector<Chunk> chunks;
+    const char* end = data + size;
+    const char* p = data;
+    while( p < end )
+    {
+        Chunk c;
+        c.begin = p;
+        c.data = data;
+        if( (size_t)(end - p) <= chunkSize )
+            c.end = end;
+        else
+        {
+            const char* nl = (const char*)memchr(p + chunkSize, '\n', end - p - chunkSize);
+            c.end = nl ? nl + 1 : end;
+        }
+        chunks.push_back(c);
+        p = c.end;
+    }
+    if( pool )
+    {
+        for( int i = 0; i < (int)chunks.size(); i++ )
+            pool->run(parseChunk, &chunks[i]);
+        pool->wait();
+    }else
+    {
+        for( int i = 0; i < (int)chunks.size(); i++ )
+            parseChunk(&chunks[i]);
+    }
+    Result res;
+    for( int i = 0; i < (int)chunks.size(); i++ )
+    {
+        const Result& r = chunks[i].result;
+        if( r.error && res.error == 0 )
+        {
+            res.error = r.error;
+            res.errorOffset = r.errorOffset;
+        }
+        res.documents += r.documents;
+        res.nodes += r.nodes;
+    }
+    return res;
+}
+
+bool NdJson::generate(const std::string& path, int megabytes, int& documents, long long& nodes,
+                      std::string& error)
+{
+    FILE* f = fopen(path.c_str(), "wb");
+    if( f == 0 )
+    {
+        error = "cannot create " + path;
+        return false;
+    }
+    som::Random r;
+    const long long size = (long long)megabytes * 1024 * 1024;
+    long long written = 0;
+    std::string buf;
+    documents = 0;
+    nodes = 0;
+    bool ok = true;
+    while( ok && written < size )
+    {
+        buf.clear();
+        while( buf.size() < 64 * 1024 )
+        {
+            nodes += appendRecord(buf, documents, r);
+            documents++;
+        }
+        ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+        written += buf.size();
+    }
+    if( fclose(f) != 0 || !ok )
+    {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef _NDJSON_H
+#define _NDJSON_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <string>
+
+class ThreadPool;
+
+// Newline delimited JSON, i.e. one document per line. parse() splits the text into line
+// aligned chunks, which the pool parses concurrently; each chunk is parsed line by line
+// into a JsonDocument of its own, whose memory is reused from line to line.
+class NdJson {
+public:
+    struct Result {
+        int documents;      // non blank lines
+        long long nodes;    // JsonDocument::nodeCount() of all documents
+        const char* error;  // of the first line which could not be parsed, or 0
+        size_t errorOffset; // of this line in the text
+        Result():documents(0),nodes(0),error(0),errorOffset(0) {}
+    };
+
+    enum { CHUNK_SIZE = 1024 * 1024 };
+    // parses on the calling thread if pool is 0
+    static Result parse(const char* data, size_t size, ThreadPool* pool, size_t chunkSize = CHUNK_SIZE);
+
+    // Writes at least megabytes MB of records with nested objects and arrays, numbers,
+    // literals and strings with escapes; the file only depends on the arguments.
+    // documents and nodes are set to the values parse() is expected to return.
+    static bool generate(const std::string& path, int megabytes, int& documents, long long& nodes,
+                         std::string& error);
+};
+
+#endif // _NDJSON_H
@@ -22,36 +22,103 @@
  * THE SOFTWARE.
  */
 
+#include "Allocator.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Reference counting policies; Ref takes one as template argument, the default is selected
+// for the whole build by the switches below. The policies must not be mixed on one object.
+// - RefCountPlain: ordinary increments and decrements; the objects must stay on one thread
+// - RefCountAtomic: the increment is a relaxed atomic operation, the decrement has release
+//   semantics and the thread dropping the last reference acquires before deleting, so
+//   objects may be shared by threads
+// - RefCountNone: no counting at all; the objects are never deleted, so the memory grows
+//   with every sample; the arena doesn't help, it only rewinds samples of which nothing
+//   is live
+// #define AWFY_REFCOUNT_ATOMIC
+// #define AWFY_REFCOUNT_NONE
+
+// the old name of AWFY_REFCOUNT_NONE
+// #define NO_GC
+#if defined(NO_GC) && !defined(AWFY_REFCOUNT_NONE)
+#define AWFY_REFCOUNT_NONE
+#endif
+
+struct RefCountPlain {
+    static void increment(int& count) {
+        count++;
+    }
+    // returns true if the object has to be deleted
+    static bool decrement(int& count) {
+        count--;
+        return count <= 0;
+    }
+};
+
+struct RefCountAtomic {
+    static void increment(int& count) {
+#if defined(_MSC_VER)
+        _InterlockedIncrement((volatile long*)&count);
+#else
+        __atomic_fetch_add(&count, 1, __ATOMIC_RELAXED);
+#endif
+    }
+    static bool decrement(int& count) {
+#if defined(_MSC_VER)
+        // full barrier
+        return _InterlockedDecrement((volatile long*)&count) <= 0;
+#else
+        if (__atomic_fetch_sub(&count, 1, __ATOMIC_RELEASE) <= 1) {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            return true;
+        }
+        return false;
+#endif
+    }
+};
+
+struct RefCountNone {
+    static void increment(int&) {}
+    static bool decrement(int&) { return false; }
+};
+
+#if defined(AWFY_REFCOUNT_NONE)
+typedef RefCountNone RefCountDefault;
+#elif defined(AWFY_REFCOUNT_ATOMIC)
+typedef RefCountAtomic RefCountDefault;
+#else
+typedef RefCountPlain RefCountDefault;
+#endif
+
 class Object {
     int refCount;
 public:
+    ALLOCATED_BY_CURRENT
     Object():refCount(0) {}
     virtual ~Object() {}
+    template <class P>
     void addRef()
     {
-        refCount++;
+        P::increment(refCount);
     }
+    template <class P>
     void release()
     {
-        refCount--;
-        if( refCount <= 0 )
+        if( P::decrement(refCount) )
             delete this;
     }
 };
 
-// #define NO_GC
-
-template <class T>
+template <class T, class P = RefCountDefault>
 class Ref
 {
     T* obj;
 public:
     Ref(T* o = 0):obj(o)
     {
-#ifndef NO_GC
         if(obj)
-            obj->addRef();
-#endif
+            obj->template addRef<P>();
     }
     Ref( const Ref& rhs ):obj(0)
     {
@@ -59,24 +126,18 @@ public:
     }
     ~Ref()
     {
-#ifndef NO_GC
         if(obj)
-            obj->release();
-#endif
+            obj->template release<P>();
     }
     Ref& operator=(T* rhs )
     {
         if( obj == rhs )
             return *this;
-#ifndef NO_GC
         if(obj)
-            obj->release();
-#endif
+            obj->template release<P>();
         obj = rhs;
-#ifndef NO_GC
         if( obj )
-            obj->addRef();
-#endif
+            obj->template addRef<P>();
         return *this;
     }
     Ref& operator=(const Ref& rhs )
@@ -0,0 +1,205 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "PerfCounters.h"
+#include "Statistics.h"
+#include <limits>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdio.h>
+#endif
+
+static const char* s_names[PerfCounters::EventCount] = {
+    "cycles", "instructions", "branch-misses", "L1-dcache-load-misses", "LLC-load-misses", "dTLB-load-misses"
+};
+
+PerfCounters::Values::Values()
+{
+    for( int i = 0; i < EventCount; i++ )
+        v[i] = std::numeric_limits<double>::quiet_NaN();
+}
+
+PerfCounters::PerfCounters():leader(-1),members(0)
+{
+    for( int i = 0; i < EventCount; i++ )
+    {
+        fds[i] = -1;
+        order[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for( int i = 0; i < EventCount; i++ )
+    {
+        if( fds[i] != -1 )
+            close(fds[i]);
+    }
+#endif
+}
+
+const char* PerfCounters::name(int event)
+{
+    return s_names[event];
+}
+
+#ifdef __linux__
+
+static unsigned long long cacheConfig(int cache, int op, int result)
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+static int openEvent(int type, unsigned long long config, int groupFd)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFd == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+bool PerfCounters::open(std::string& error)
+{
+    if( isOpen() )
+        return true;
+    const int types[EventCount] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                    PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE };
+    const unsigned long long configs[EventCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+        cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS),
+        cacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS),
+        cacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)
+    };
+    for( int i = 0; i < EventCount; i++ )
+    {
+        const int fd = openEvent(types[i], configs[i], leader);
+        if( fd == -1 )
+        {
+            if( i == Cycles )
+            {
+                error = strerror(errno);
+                FILE* f = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+                int level;
+                if( f && fscanf(f, "%d", &level) == 1 )
+                {
+                    char buf[64];
+                    sprintf(buf, " (perf_event_paranoid=%d)", level);
+                    error += buf;
+                }
+                if( f )
+                    fclose(f);
+                return false;
+            }
+            continue; // this PMU or kernel doesn't support the event; leave it out
+        }
+        if( leader == -1 )
+            leader = fd;
+        fds[i] = fd;
+        order[members++] = i;
+    }
+    return true;
+}
+
+void PerfCounters::start()
+{
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::Values PerfCounters::stop()
+{
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    Values res;
+    unsigned long long buf[3 + EventCount];
+    const int len = (3 + members) * sizeof(unsigned long long);
+    if( read(leader, buf, len) != len || buf[2] == 0 )
+        return res;
+    // scale in case the group was multiplexed with other users of the PMU
+    const double scale = (double)buf[1] / buf[2];
+    for( int i = 0; i < members && i < (int)buf[0]; i++ )
+        res.v[order[i]] = buf[3 + i] * scale;
+    return res;
+}
+
+#else
+
+bool PerfCounters::open(std::string& error)
+{
+    error = "not supported on this platform";
+    return false;
+}
+
+void PerfCounters::start()
+{
+}
+
+PerfCounters::Values PerfCounters::stop()
+{
+    return Values();
+}
+
+#endif
+
+PerfCounters::Values PerfCounters::median(const std::vector<Values>& samples, int from)
+{
+    Values res;
+    for( int e = 0; e < EventCount; e++ )
+    {
+        std::vector<double> v;
+        for( int i = from; i < (int)samples.size(); i++ )
+        {
+            if( samples[i].has(e) )
+                v.push_back(samples[i].v[e]);
+        }
+        if( !v.empty() )
+            res.v[e] = Statistics::median(v);
+    }
+    return res;
+}
+
+double PerfCounters::ipc(const std::vector<Values>& samples, int from)
+{
+    double cycles = 0, instructions = 0;
+    for( int i = from; i < (int)samples.size(); i++ )
+    {
+        if( samples[i].has(Cycles) && samples[i].has(Instructions) )
+        {
+            cycles += samples[i].v[Cycles];
+            instructions += samples[i].v[Instructions];
+        }
+    }
+    if( cycles == 0 )
+        return std::numeric_limits<double>::quiet_NaN();
+    return instructions / cycles;
+}
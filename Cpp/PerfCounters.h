@@ -0,0 +1,63 @@
+#ifndef _PERFCOUNTERS_H
+#define _PERFCOUNTERS_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+
+// Hardware performance counters read around each Run::measure sample. On Linux the
+// counters are opened as one perf_event_open group, counting user space only; events
+// the PMU or the kernel refuses are left out, and if even the cycle counter cannot be
+// opened the counters are unavailable (e.g. other platforms, perf_event_paranoid > 2,
+// or virtual machines without PMU passthrough).
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, BranchMisses, L1dMisses, LlcMisses, DtlbMisses, EventCount };
+
+    struct Values {
+        double v[EventCount]; // NaN if the event was not counted
+        Values();
+        bool has(int event) const { return v[event] == v[event]; }
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    bool open(std::string& error);
+    bool isOpen() const { return leader != -1; }
+    void start();
+    Values stop();
+
+    static const char* name(int event);
+    // per event median of the samples from index 'from' on
+    static Values median(const std::vector<Values>& samples, int from);
+    // instructions per cycle over the samples from index 'from' on, NaN if not counted
+    static double ipc(const std::vector<Values>& samples, int from);
+private:
+    int leader;
+    int fds[EventCount];
+    int order[EventCount]; // event of the n-th group member
+    int members;
+};
+
+#endif // _PERFCOUNTERS_H
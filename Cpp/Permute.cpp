@@ -22,6 +22,7 @@
  */
 
 #include "Permute.h"
+#include "Registry.h"
 
 int Permute::benchmark()
 {
@@ -52,3 +53,5 @@ void Permute::swap(int i, int j)
     v[i] = v[j];
     v[j] = tmp;
 }
+
+static Registration<Permute> registration("Permute", Registry::Micro, 1000, 1);
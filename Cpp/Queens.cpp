@@ -22,6 +22,7 @@
  */
 
 #include "Queens.h"
+#include "Registry.h"
 
 int Queens::benchmark()
 {
@@ -92,3 +93,5 @@ void Queens::setRowColumn(int r, int c, bool v)
     freeMaxs[c + r    ] = v;
     freeMins[c - r + 7] = v;
 }
+
+static Registration<Queens> registration("Queens", Registry::Micro, 1000, 1);
@@ -25,6 +25,8 @@
  */
 
 #include <som/Interfaces.h>
+#include <som/Vector.h>
+#include "Allocator.h"
 
 template <class K, class V, class C>
 class RedBlackTree {
@@ -33,32 +35,34 @@ class RedBlackTree {
         RED, BLACK
     };
 
+    // The color is kept in the lowest bit of the parent pointer; nodes are at least
+    // pointer aligned, so the bit is otherwise always zero.
     template <class KK, class VV>
     class Node {
         Node();
+        size_t parentColor;
     public:
         KK    key;
         VV value;
         Node<KK, VV>* left;
         Node<KK, VV>* right;
-        Node<KK, VV>* parent;
-        Color color;
-        Node(const KK& key, const VV& value) {
-            this->key = key;
-            this->value = value;
-            this->left = 0;
-            this->right = 0;
-            this->parent = 0;
-            this->color = RED;
-        }
-
-        ~Node()
-        {
-            // this is apparently enough to get rid of all Node
-            if( left )
-                delete left;
-            if( right )
-                delete right;
+
+        Node(const KK& key, const VV& value):parentColor(RED),key(key),value(value),left(0),right(0) {}
+
+        Node<KK, VV>* parent() const {
+            return (Node<KK, VV>*)(parentColor & ~(size_t)1);
+        }
+
+        void setParent(Node<KK, VV>* p) {
+            parentColor = (size_t)p | (parentColor & 1);
+        }
+
+        Color color() const {
+            return (Color)(parentColor & 1);
+        }
+
+        void setColor(Color c) {
+            parentColor = (parentColor & ~(size_t)1) | c;
         }
 
         Node<KK, VV>* successor() {
@@ -66,10 +70,25 @@ class RedBlackTree {
             if (x->right != 0) {
                 return treeMinimum(x->right);
             }
-            Node<KK, VV>* y = x->parent;
+
+            Node<KK, VV>* y = x->parent();
             while (y != 0 && x == y->right) {
                 x = y;
-                y = y->parent;
+                y = y->parent();
+            }
+            return y;
+        }
+
+        Node<KK, VV>* predecessor() {
+            Node<KK, VV>* x = this;
+            if (x->left != 0) {
+                return treeMaximum(x->left);
+            }
+
+            Node<KK, VV>* y = x->parent();
+            while (y != 0 && x == y->left) {
+                x = y;
+                y = y->parent();
             }
             return y;
         }
@@ -84,20 +103,79 @@ class RedBlackTree {
         return current;
     }
 
+    template <class KK, class VV>
+    static Node<KK, VV>* treeMaximum(Node<KK, VV>* x) {
+        Node<KK, VV>* current = x;
+        while (current->right != 0) {
+            current = current->right;
+        }
+        return current;
+    }
+
 
     Node<K, V>* root;
     bool isNewEntry;
     Node<K, V>* newNode;
     V oldValue;
+
+    // The nodes are allocated from chunks owned by the tree, which start with MIN_CHUNK
+    // nodes and double up to MAX_CHUNK; removed nodes are kept in a free list linked
+    // by their left pointer.
+    enum { MIN_CHUNK = 8, MAX_CHUNK = 256 };
+    struct Chunk {
+        Chunk* next;
+        int capacity;
+        Node<K, V>* nodes() { return (Node<K, V>*)(this + 1); }
+    };
+    Chunk* chunks;
+    int used; // nodes handed out from the first chunk
+    Node<K, V>* freeList;
+
+    RedBlackTree(const RedBlackTree&);
+    RedBlackTree& operator=(const RedBlackTree&);
 public:
-    RedBlackTree() {
-        root = 0;
+    RedBlackTree():root(0),chunks(0),used(0),freeList(0) {
     }
 
     ~RedBlackTree()
     {
-        if( root )
-            delete root;
+        removeAll();
+        Allocator::deallocate(chunks);
+    }
+
+    // destroys the nodes without recursion; only the last chunk is kept for reuse
+    void removeAll() {
+        Node<K, V>* current = root;
+        while (current != 0) {
+            if (current->left != 0) {
+                current = current->left;
+            } else if (current->right != 0) {
+                current = current->right;
+            } else {
+                Node<K, V>* parent = current->parent();
+                if (parent != 0) {
+                    if (parent->left == current) {
+                        parent->left = 0;
+                    } else {
+                        parent->right = 0;
+                    }
+                }
+                current->~Node<K, V>();
+                current = parent;
+            }
+        }
+        root = 0;
+        freeList = 0;
+        used = 0;
+        if (chunks != 0) {
+            Chunk* c = chunks->next;
+            chunks->next = 0;
+            while (c != 0) {
+                Chunk* next = c->next;
+                Allocator::deallocate(c);
+                c = next;
+            }
+        }
     }
 
     V* put(const K& key, const V& value) {
@@ -107,56 +185,54 @@ public:
         }
         Node<K, V>* x = newNode;
 
-        while (x != root && x->parent->color == RED) {
-            if (x->parent == x->parent->parent->left) {
-                Node<K, V>* y = x->parent->parent->right;
-                if (y != 0 && y->color == RED) {
+        while (x != root && x->parent()->color() == RED) {
+            if (x->parent() == x->parent()->parent()->left) {
+                Node<K, V>* y = x->parent()->parent()->right;
+                if (y != 0 && y->color() == RED) {
                     // Case 1
-                    x->parent->color = BLACK;
-                    y->color = BLACK;
-                    x->parent->parent->color = RED;
-                    x = x->parent->parent;
+                    x->parent()->setColor(BLACK);
+                    y->setColor(BLACK);
+                    x->parent()->parent()->setColor(RED);
+                    x = x->parent()->parent();
                 } else {
-                    if (x == x->parent->right) {
+                    if (x == x->parent()->right) {
                         // Case 2
-                        x = x->parent;
+                        x = x->parent();
                         leftRotate(x);
                     }
                     // Case 3
-                    x->parent->color = BLACK;
-                    x->parent->parent->color = RED;
-                    rightRotate(x->parent->parent);
+                    x->parent()->setColor(BLACK);
+                    x->parent()->parent()->setColor(RED);
+                    rightRotate(x->parent()->parent());
                 }
             } else {
                 // Same as "then" clause with "right" and "left" exchanged.
-                Node<K, V>* y = x->parent->parent->left;
-                if (y != 0 && y->color == RED) {
+                Node<K, V>* y = x->parent()->parent()->left;
+                if (y != 0 && y->color() == RED) {
                     // Case 1
-                    x->parent->color = BLACK;
-                    y->color = BLACK;
-                    x->parent->parent->color = RED;
-                    x = x->parent->parent;
+                    x->parent()->setColor(BLACK);
+                    y->setColor(BLACK);
+                    x->parent()->parent()->setColor(RED);
+                    x = x->parent()->parent();
                 } else {
-                    if (x == x->parent->left) {
+                    if (x == x->parent()->left) {
                         // Case 2
-                        x = x->parent;
+                        x = x->parent();
                         rightRotate(x);
                     }
                     // Case 3
-                    x->parent->color = BLACK;
-                    x->parent->parent->color = RED;
-                    leftRotate(x->parent->parent);
+                    x->parent()->setColor(BLACK);
+                    x->parent()->parent()->setColor(RED);
+                    leftRotate(x->parent()->parent());
                 }
             }
         }
 
-        root->color = BLACK;
+        root->setColor(BLACK);
         return 0;
     }
 
     V remove(const K& key) {
-        // NOTE: apparently we don't get here during CD, otherwise we
-        // should take care of Node dealloc
         Node<K, V>* z = findNode(key);
         if (z == 0) {
             return V();
@@ -182,51 +258,53 @@ public:
         // this point.
         Node<K, V>* xParent;
         if (x != 0) {
-            x->parent = y->parent;
-            xParent = x->parent;
+            x->setParent(y->parent());
+            xParent = x->parent();
         } else {
-            xParent = y->parent;
+            xParent = y->parent();
         }
-        if (y->parent == 0) {
+        if (y->parent() == 0) {
             root = x;
         } else {
-            if (y == y->parent->left) {
-                y->parent->left = x;
+            if (y == y->parent()->left) {
+                y->parent()->left = x;
             } else {
-                y->parent->right = x;
+                y->parent()->right = x;
             }
         }
 
         if (y != z) {
-            if (y->color == BLACK) {
+            if (y->color() == BLACK) {
                 removeFixup(x, xParent);
             }
 
-            y->parent = z->parent;
-            y->color = z->color;
+            y->setParent(z->parent());
+            y->setColor(z->color());
             y->left = z->left;
             y->right = z->right;
 
             if (z->left != 0) {
-                z->left->parent = y;
+                z->left->setParent(y);
             }
             if (z->right != 0) {
-                z->right->parent = y;
+                z->right->setParent(y);
             }
-            if (z->parent != 0) {
-                if (z->parent->left == z) {
-                    z->parent->left = y;
+            if (z->parent() != 0) {
+                if (z->parent()->left == z) {
+                    z->parent()->left = y;
                 } else {
-                    z->parent->right = y;
+                    z->parent()->right = y;
                 }
             } else {
                 root = y;
             }
-        } else if (y->color == BLACK) {
+        } else if (y->color() == BLACK) {
             removeFixup(x, xParent);
         }
 
-        return z->value;
+        const V value = z->value;
+        freeNode(z);
+        return value;
     }
 
     V* get(const K& key) {
@@ -237,17 +315,123 @@ public:
         return &node->value;
     }
 
+    // refers to the key and value in the tree, so visiting a node copies neither
     template <class KK, class VV>
     class Entry {
     public:
-        KK key;
-        VV value;
-        Entry(const KK& key, const VV& value) {
-            this->key = key;
-            this->value = value;
+        const KK& key;
+        const VV& value;
+        Entry(const KK& key, const VV& value):key(key),value(value) {}
+    };
+
+    // In-order bidirectional iterator; end() is one past the largest key. Only removing
+    // the node an iterator points to invalidates it.
+    class iterator {
+        friend class RedBlackTree;
+        RedBlackTree* tree;
+        Node<K, V>* node;
+        iterator(RedBlackTree* t, Node<K, V>* n):tree(t),node(n) {}
+    public:
+        iterator():tree(0),node(0) {}
+
+        const K& key() const { return node->key; }
+        V& value() const { return node->value; }
+        Entry<K, V> operator*() const { return Entry<K, V>(node->key, node->value); }
+
+        iterator& operator++() {
+            node = node->successor();
+            return *this;
         }
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            node = node->successor();
+            return tmp;
+        }
+
+        // decrementing end() yields the largest key
+        iterator& operator--() {
+            if (node == 0) {
+                node = tree->root == 0 ? 0 : treeMaximum(tree->root);
+            } else {
+                node = node->predecessor();
+            }
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const iterator& rhs) const { return node == rhs.node; }
+        bool operator!=(const iterator& rhs) const { return node != rhs.node; }
     };
 
+    iterator begin() {
+        return iterator(this, root == 0 ? 0 : treeMinimum(root));
+    }
+
+    iterator end() {
+        return iterator(this, 0);
+    }
+
+    // the first entry whose key is not less than key
+    iterator lowerBound(const K& key) {
+        Node<K, V>* current = root;
+        Node<K, V>* res = 0;
+        C compareTo;
+        while (current != 0) {
+            if (compareTo(current->key, key) < 0) {
+                current = current->right;
+            } else {
+                res = current;
+                current = current->left;
+            }
+        }
+        return iterator(this, res);
+    }
+
+    // the first entry whose key is greater than key
+    iterator upperBound(const K& key) {
+        Node<K, V>* current = root;
+        Node<K, V>* res = 0;
+        C compareTo;
+        while (current != 0) {
+            if (compareTo(key, current->key) < 0) {
+                res = current;
+                current = current->left;
+            } else {
+                current = current->right;
+            }
+        }
+        return iterator(this, res);
+    }
+
+    // Replaces the contents by the given entries in linear time, without comparisons
+    // or rebalancing; the keys must be in strictly ascending order.
+    void build(const som::Vector<K>& keys, const som::Vector<V>& values) {
+        const int n = keys.size();
+        if (values.size() != n) {
+            throw "size mismatch";
+        }
+        C compareTo;
+        for (int i = 1; i < n; i++) {
+            if (compareTo(keys.at(i - 1), keys.at(i)) >= 0) {
+                throw "keys not ascending";
+            }
+        }
+        removeAll();
+        // levels 0 to redDepth - 1 of the balanced tree are complete, the nodes on the
+        // partial level below are colored red, which keeps the black heights equal
+        int redDepth = 0;
+        while ((2 << redDepth) - 1 <= n) {
+            redDepth++;
+        }
+        root = buildRange(keys, values, 0, n, 0, redDepth, 0);
+    }
+
     void forEach(som::ForEachInterface<Entry<K, V> >& fn) {
         if (root == 0) {
             return;
@@ -259,7 +443,59 @@ public:
         }
     }
 
+    template<class F>
+    typename som::EnableIf<!som::IsDerived<F, som::ForEachInterface<Entry<K, V> > >::value>::Type forEach(F fn) {
+        if (root == 0) {
+            return;
+        }
+        Node<K, V>* current = treeMinimum(root);
+        while (current != 0) {
+            fn(Entry<K, V>(current->key, current->value));
+            current = current->successor();
+        }
+    }
+
 private:
+    Node<K, V>* buildRange(const som::Vector<K>& keys, const som::Vector<V>& values,
+                           int from, int to, int depth, int redDepth, Node<K, V>* parent) {
+        if (from >= to) {
+            return 0;
+        }
+        const int mid = (from + to) / 2;
+        Node<K, V>* n = allocNode(keys.at(mid), values.at(mid));
+        n->setParent(parent);
+        n->setColor(depth == redDepth ? RED : BLACK);
+        n->left = buildRange(keys, values, from, mid, depth + 1, redDepth, n);
+        n->right = buildRange(keys, values, mid + 1, to, depth + 1, redDepth, n);
+        return n;
+    }
+
+    Node<K, V>* allocNode(const K& key, const V& value) {
+        Node<K, V>* n;
+        if (freeList != 0) {
+            n = freeList;
+            freeList = n->left;
+        } else {
+            if (chunks == 0 || used == chunks->capacity) {
+                const int capacity = chunks == 0 ? MIN_CHUNK :
+                                     chunks->capacity < MAX_CHUNK ? chunks->capacity * 2 : MAX_CHUNK;
+                Chunk* c = (Chunk*)Allocator::allocate(sizeof(Chunk) + capacity * sizeof(Node<K, V>));
+                c->next = chunks;
+                c->capacity = capacity;
+                chunks = c;
+                used = 0;
+            }
+            n = chunks->nodes() + used++;
+        }
+        return new(n) Node<K, V>(key, value);
+    }
+
+    void freeNode(Node<K, V>* n) {
+        n->~Node<K, V>();
+        n->left = freeList;
+        freeList = n;
+    }
+
     Node<K, V>* findNode(const K& key) {
         Node<K, V>* current = root;
         C compareTo;
@@ -303,8 +539,8 @@ private:
             }
         }
 
-        Node<K, V>* z = new Node<K, V>(key, value);
-        z->parent = y;
+        Node<K, V>* z = allocNode(key, value);
+        z->setParent(y);
         if (y == 0) {
             root = z;
         } else {
@@ -323,24 +559,24 @@ private:
         // Turn y's left subtree into x's right subtree.
         x->right = y->left;
         if (y->left != 0) {
-            y->left->parent = x;
+            y->left->setParent(x);
         }
 
         // Link x's parent to y.
-        y->parent = x->parent;
-        if (x->parent == 0) {
+        y->setParent(x->parent());
+        if (x->parent() == 0) {
             root = y;
         } else {
-            if (x == x->parent->left) {
-                x->parent->left = y;
+            if (x == x->parent()->left) {
+                x->parent()->left = y;
             } else {
-                x->parent->right = y;
+                x->parent()->right = y;
             }
         }
 
         // Put x on y's left.
         y->left = x;
-        x->parent = y;
+        x->setParent(y);
 
         return y;
     }
@@ -351,103 +587,103 @@ private:
         // Turn x's right subtree into y's left subtree.
         y->left = x->right;
         if (x->right != 0) {
-            x->right->parent = y;
+            x->right->setParent(y);
         }
 
         // Link y's parent to x;
-        x->parent = y->parent;
-        if (y->parent == 0) {
+        x->setParent(y->parent());
+        if (y->parent() == 0) {
             root = x;
         } else {
-            if (y == y->parent->left) {
-                y->parent->left = x;
+            if (y == y->parent()->left) {
+                y->parent()->left = x;
             } else {
-                y->parent->right = x;
+                y->parent()->right = x;
             }
         }
 
         x->right = y;
-        y->parent = x;
+        y->setParent(x);
 
         return x;
     }
 
     void removeFixup(Node<K, V>* x, Node<K, V>* xParent) {
-        while (x != root && (x == 0 || x->color == BLACK)) {
+        while (x != root && (x == 0 || x->color() == BLACK)) {
             if (x == xParent->left) {
                 // Note: the text points out that w cannot be null. The reason is not obvious from
                 // simply looking at the code; it comes about from the properties of the red-black
                 // tree.
                 Node<K, V>* w = xParent->right;
-                if (w->color == RED) {
+                if (w->color() == RED) {
                     // Case 1
-                    w->color = BLACK;
-                    xParent->color = RED;
+                    w->setColor(BLACK);
+                    xParent->setColor(RED);
                     leftRotate(xParent);
                     w = xParent->right;
                 }
-                if ((w->left == 0 || w->left->color == BLACK)
-                        && (w->right == 0 || w->right->color == BLACK)) {
+                if ((w->left == 0 || w->left->color() == BLACK)
+                        && (w->right == 0 || w->right->color() == BLACK)) {
                     // Case 2
-                    w->color = RED;
+                    w->setColor(RED);
                     x = xParent;
-                    xParent = x->parent;
+                    xParent = x->parent();
                 } else {
-                    if (w->right == 0 || w->right->color == BLACK) {
+                    if (w->right == 0 || w->right->color() == BLACK) {
                         // Case 3
-                        w->left->color = BLACK;
-                        w->color = RED;
+                        w->left->setColor(BLACK);
+                        w->setColor(RED);
                         rightRotate(w);
                         w = xParent->right;
                     }
                     // Case 4
-                    w->color = xParent->color;
-                    xParent->color = BLACK;
+                    w->setColor(xParent->color());
+                    xParent->setColor(BLACK);
                     if (w->right != 0) {
-                        w->right->color = BLACK;
+                        w->right->setColor(BLACK);
                     }
                     leftRotate(xParent);
                     x = root;
-                    xParent = x->parent;
+                    xParent = x->parent();
                 }
             } else {
                 // Same as "then" clause with "right" and "left" exchanged.
                 Node<K, V>* w = xParent->left;
-                if (w->color == RED) {
+                if (w->color() == RED) {
                     // Case 1
-                    w->color = BLACK;
-                    xParent->color = RED;
+                    w->setColor(BLACK);
+                    xParent->setColor(RED);
                     rightRotate(xParent);
                     w = xParent->left;
                 }
-                if ((w->right == 0 || w->right->color == BLACK)
-                        && (w->left == 0 || w->left->color == BLACK)) {
+                if ((w->right == 0 || w->right->color() == BLACK)
+                        && (w->left == 0 || w->left->color() == BLACK)) {
                     // Case 2
-                    w->color = RED;
+                    w->setColor(RED);
                     x = xParent;
-                    xParent = x->parent;
+                    xParent = x->parent();
                 } else {
-                    if (w->left == 0 || w->left->color == BLACK) {
+                    if (w->left == 0 || w->left->color() == BLACK) {
                         // Case 3
-                        w->right->color = BLACK;
-                        w->color = RED;
+                        w->right->setColor(BLACK);
+                        w->setColor(RED);
                         leftRotate(w);
                         w = xParent->left;
                     }
                     // Case 4
-                    w->color = xParent->color;
-                    xParent->color = BLACK;
+                    w->setColor(xParent->color());
+                    xParent->setColor(BLACK);
                     if (w->left != 0) {
-                        w->left->color = BLACK;
+                        w->left->setColor(BLACK);
                     }
                     rightRotate(xParent);
                     x = root;
-                    xParent = x->parent;
+                    xParent = x->parent();
                 }
             }
         }
         if (x != 0) {
-            x->color = BLACK;
+            x->setColor(BLACK);
         }
     }
 };
@@ -0,0 +1,168 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Registry.h"
+#include <algorithm>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <regex.h>
+#define HAVE_REGEX
+#endif
+
+static std::vector<Registry::Info>& registry()
+{
+    // function local so it is initialized before the first static Registration runs
+    static std::vector<Registry::Info> infos;
+    return infos;
+}
+
+static bool lessThan(const Registry::Info* lhs, const Registry::Info* rhs)
+{
+    if( lhs->kind != rhs->kind )
+        return lhs->kind < rhs->kind;
+    return strcmp(lhs->name, rhs->name) < 0;
+}
+
+bool Registry::Info::canVerify(int innerIterations) const
+{
+    if( verifiedInnerIterations == 0 )
+        return true;
+    for( const int* i = verifiedInnerIterations; *i != 0; i++ )
+    {
+        if( *i == innerIterations )
+            return true;
+    }
+    return false;
+}
+
+void Registry::add(const Info& info)
+{
+    registry().push_back(info);
+}
+
+const Registry::Info* Registry::find(const std::string& name)
+{
+    std::vector<Info>& infos = registry();
+    for( int i = 0; i < (int)infos.size(); i++ )
+    {
+        if( name == infos[i].name )
+            return &infos[i];
+    }
+    return 0;
+}
+
+std::vector<const Registry::Info*> Registry::all()
+{
+    std::vector<Info>& infos = registry();
+    std::vector<const Info*> res;
+    for( int i = 0; i < (int)infos.size(); i++ )
+        res.push_back(&infos[i]);
+    std::sort(res.begin(), res.end(), lessThan);
+    return res;
+}
+
+bool Registry::glob(const char* pattern, const char* name)
+{
+    // iterative matcher with backtracking to the last '*'
+    const char* star = 0;
+    const char* resume = 0;
+    while( *name )
+    {
+        if( *pattern == '*' )
+        {
+            star = pattern++;
+            resume = name;
+        }else if( *pattern == '?' || *pattern == *name )
+        {
+            pattern++;
+            name++;
+        }else if( star )
+        {
+            pattern = star + 1;
+            name = ++resume;
+        }else
+            return false;
+    }
+    while( *pattern == '*' )
+        pattern++;
+    return *pattern == 0;
+}
+
+static bool matches(const std::string& pattern, const char* name, std::string& error)
+{
+    if( pattern.size() >= 2 && pattern[0] == '/' && pattern[pattern.size()-1] == '/' )
+    {
+#ifdef HAVE_REGEX
+        regex_t re;
+        const std::string expr = pattern.substr(1, pattern.size() - 2);
+        if( regcomp(&re, expr.c_str(), REG_EXTENDED | REG_NOSUB) != 0 )
+        {
+            error = "invalid regular expression " + pattern;
+            return false;
+        }
+        const bool res = regexec(&re, name, 0, 0, 0) == 0;
+        regfree(&re);
+        return res;
+#else
+        error = "regular expressions are not supported on this platform";
+        return false;
+#endif
+    }
+    return Registry::glob(pattern.c_str(), name);
+}
+
+bool Registry::select(const std::string& patterns, std::vector<const Info*>& result, std::string& error)
+{
+    std::vector<std::string> include, exclude;
+    std::string::size_type pos = 0;
+    while( pos <= patterns.size() )
+    {
+        std::string::size_type end = patterns.find(',', pos);
+        if( end == std::string::npos )
+            end = patterns.size();
+        const std::string p = patterns.substr(pos, end - pos);
+        if( !p.empty() && p[0] == '-' )
+            exclude.push_back(p.substr(1));
+        else if( !p.empty() )
+            include.push_back(p);
+        pos = end + 1;
+    }
+    if( include.empty() )
+        include.push_back("*");
+
+    result.clear();
+    error.clear();
+    const std::vector<const Info*> infos = all();
+    for( int i = 0; i < (int)infos.size(); i++ )
+    {
+        bool selected = false;
+        for( int j = 0; j < (int)include.size() && !selected; j++ )
+            selected = matches(include[j], infos[i]->name, error);
+        for( int j = 0; j < (int)exclude.size() && selected; j++ )
+            selected = !matches(exclude[j], infos[i]->name, error);
+        if( !error.empty() )
+            return false;
+        if( selected )
+            result.push_back(infos[i]);
+    }
+    return true;
+}
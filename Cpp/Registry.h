@@ -0,0 +1,88 @@
+#ifndef _REGISTRY_H
+#define _REGISTRY_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+
+// Registry of all benchmarks linked into the executable. Each benchmark translation
+// unit adds itself with a static Registration object, so the driver can enumerate and
+// filter the benchmarks without a central list. Note that this relies on the object
+// files being linked directly (i.e. not via a static library, where the linker would
+// drop the unreferenced registrations).
+class Registry {
+public:
+    enum Kind { Macro, Micro }; // enumeration order, macro benchmarks first
+
+    typedef Benchmark* (*Factory)();
+
+    struct Info {
+        const char* name;
+        Kind kind;
+        Factory create;
+        int numIterations;      // default outer iterations
+        int innerIterations;    // default inner iterations
+        // zero terminated list of the inner iterations for which the benchmark knows
+        // the correct result, or null if the result does not depend on them
+        const int* verifiedInnerIterations;
+
+        bool canVerify(int innerIterations) const;
+    };
+
+    static void add(const Info&);
+    static const Info* find(const std::string& name);
+
+    // all benchmarks, sorted by kind and name
+    static std::vector<const Info*> all();
+
+    // Benchmarks matching a comma separated list of patterns. A pattern is either a
+    // glob with '*' and '?' or, if enclosed in slashes, an extended regular expression.
+    // A pattern prefixed with '-' removes the matching benchmarks from the selection;
+    // if the list only consists of such patterns they are applied to all benchmarks.
+    // Returns false and an error message in case of an invalid pattern.
+    static bool select(const std::string& patterns, std::vector<const Info*>& result, std::string& error);
+
+    static bool glob(const char* pattern, const char* name);
+};
+
+template<class T>
+class Registration {
+public:
+    Registration(const char* name, Registry::Kind kind, int numIterations, int innerIterations,
+                 const int* verifiedInnerIterations = 0) {
+        Registry::Info info;
+        info.name = name;
+        info.kind = kind;
+        info.create = create;
+        info.numIterations = numIterations;
+        info.innerIterations = innerIterations;
+        info.verifiedInnerIterations = verifiedInnerIterations;
+        Registry::add(info);
+    }
+    static Benchmark* create() {
+        return new T();
+    }
+};
+
+#endif // _REGISTRY_H
@@ -0,0 +1,263 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Report.h"
+#include "Run.h"
+#include "Clock.h"
+#include <fstream>
+#include <iomanip>
+
+static std::string quoted(const std::string& str)
+{
+    std::string res = "\"";
+    for( int i = 0; i < (int)str.size(); i++ )
+    {
+        const char ch = str[i];
+        if( ch == '"' || ch == '\\' )
+        {
+            res += '\\';
+            res += ch;
+        }else if( (unsigned char)ch < 0x20 )
+            res += ' ';
+        else
+            res += ch;
+    }
+    res += '"';
+    return res;
+}
+
+// events which were not counted are written as null in JSON and as empty fields in CSV
+static void writeCount(std::ostream& out, double value, bool json)
+{
+    if( value != value )
+        out << (json ? "null" : "");
+    else
+        out << std::setprecision(0) << value << std::setprecision(3);
+}
+
+void Report::add(const Run& run, int repeat)
+{
+    Record r;
+    r.name = run.getName();
+    r.allocator = run.getAllocatorName();
+    r.repeat = repeat;
+    r.numIterations = run.getNumIterations();
+    r.innerIterations = run.getInnerIterations();
+    r.failed = run.hasFailed();
+    r.samples = run.getSamples();
+    r.summary = run.getSummary();
+    r.hasCounters = run.hasCounters();
+    r.counterSamples = run.getCounterSamples();
+    r.counterSummary = run.getCounterSummary();
+    r.ipc = run.getIpc();
+    r.allocSamples = run.getAllocSamples();
+    r.allocSummary = run.getAllocSummary();
+    r.allocationRate = run.getAllocationRate();
+    r.threads = run.getThreads();
+    r.throughput = run.getThroughput();
+    r.threadSummaries = run.getThreadSummaries();
+    records.push_back(r);
+}
+
+void Report::writeJson(std::ostream& out) const
+{
+    out << std::fixed << std::setprecision(3);
+    out << "{" << std::endl;
+    out << "  \"clock\": " << quoted(Clock::current()->name()) << "," << std::endl;
+    out << "  \"unit\": \"us\"," << std::endl;
+    out << "  \"results\": [" << std::endl;
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        const Record& r = records[i];
+        const Statistics::Summary& s = r.summary;
+        out << "    {" << std::endl;
+        out << "      \"benchmark\": " << quoted(r.name) << "," << std::endl;
+        out << "      \"allocator\": " << quoted(r.allocator) << "," << std::endl;
+        out << "      \"repeat\": " << r.repeat << "," << std::endl;
+        out << "      \"iterations\": " << r.numIterations << "," << std::endl;
+        out << "      \"innerIterations\": " << r.innerIterations << "," << std::endl;
+        out << "      \"failed\": " << (r.failed ? "true" : "false") << "," << std::endl;
+        out << "      \"threads\": " << r.threads << "," << std::endl;
+        out << "      \"throughput\": " << r.throughput << "," << std::endl;
+        out << "      \"summary\": { \"warmup\": " << s.warmup << ", \"count\": " << s.count <<
+               ", \"mean\": " << s.mean << ", \"min\": " << s.min << ", \"max\": " << s.max <<
+               ", \"median\": " << s.median << ", \"p5\": " << s.p5 << ", \"p95\": " << s.p95 <<
+               ", \"p99\": " << s.p99 << ", \"mad\": " << s.mad <<
+               ", \"ciLow\": " << s.ciLow << ", \"ciHigh\": " << s.ciHigh << " }," << std::endl;
+        if( !r.threadSummaries.empty() )
+        {
+            out << "      \"threadSummaries\": [";
+            for( int t = 0; t < (int)r.threadSummaries.size(); t++ )
+            {
+                const Statistics::Summary& ts = r.threadSummaries[t];
+                out << (t != 0 ? ", " : "") << "{ \"median\": " << ts.median << ", \"p5\": " << ts.p5 <<
+                       ", \"p95\": " << ts.p95 << ", \"mad\": " << ts.mad << " }";
+            }
+            out << "]," << std::endl;
+        }
+        if( r.hasCounters )
+        {
+            out << "      \"counters\": {";
+            for( int e = 0; e < PerfCounters::EventCount; e++ )
+            {
+                out << " " << quoted(PerfCounters::name(e)) << ": ";
+                writeCount(out, r.counterSummary.v[e], true);
+                out << ",";
+            }
+            out << " \"ipc\": ";
+            if( r.ipc == r.ipc )
+                out << r.ipc;
+            else
+                out << "null";
+            out << " }," << std::endl;
+            out << "      \"counterSamples\": [";
+            for( int j = 0; j < (int)r.counterSamples.size(); j++ )
+            {
+                out << (j != 0 ? ", [" : "[");
+                for( int e = 0; e < PerfCounters::EventCount; e++ )
+                {
+                    if( e != 0 )
+                        out << ", ";
+                    writeCount(out, r.counterSamples[j].v[e], true);
+                }
+                out << "]";
+            }
+            out << "]," << std::endl;
+        }
+        if( !r.allocSamples.empty() )
+        {
+            const AllocStats::Sample& a = r.allocSummary;
+            out << "      \"allocations\": { \"allocations\": " << a.allocations << ", \"deallocations\": " <<
+                   a.deallocations << ", \"bytes\": " << a.bytes << ", \"peakLive\": " << a.peak <<
+                   ", \"rate\": " << r.allocationRate << ", \"sizeClasses\": [";
+            for( int c = 0; c < AllocStats::SIZE_CLASSES; c++ )
+            {
+                out << (c != 0 ? ", " : "") << "{ \"maxBytes\": ";
+                if( c == AllocStats::SIZE_CLASSES - 1 )
+                    out << "null";
+                else
+                    out << AllocStats::sizeClassLimit(c);
+                out << ", \"count\": " << a.histogram[c] << " }";
+            }
+            out << "] }," << std::endl;
+            out << "      \"allocationSamples\": [";
+            for( int j = 0; j < (int)r.allocSamples.size(); j++ )
+            {
+                const AllocStats::Sample& s = r.allocSamples[j];
+                out << (j != 0 ? ", " : "") << "[" << s.allocations << ", " << s.bytes << ", " << s.peak << "]";
+            }
+            out << "]," << std::endl;
+        }
+        out << "      \"samples\": [";
+        for( int j = 0; j < (int)r.samples.size(); j++ )
+        {
+            if( j != 0 )
+                out << ", ";
+            out << r.samples[j];
+        }
+        out << "]" << std::endl;
+        out << "    }" << (i + 1 < (int)records.size() ? "," : "") << std::endl;
+    }
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+void Report::writeCsv(std::ostream& out) const
+{
+    out << std::fixed << std::setprecision(3);
+    out << "benchmark,allocator,repeat,threads,iterations,inner_iterations,failed,warmup,count,"
+           "mean_us,min_us,max_us,median_us,p5_us,p95_us,p99_us,mad_us,ci_low_us,ci_high_us";
+    for( int e = 0; e < PerfCounters::EventCount; e++ )
+        out << "," << PerfCounters::name(e);
+    out << ",ipc,throughput,allocations,alloc_bytes,peak_live_bytes,alloc_rate" << std::endl;
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        const Record& r = records[i];
+        const Statistics::Summary& s = r.summary;
+        out << r.name << "," << r.allocator << "," << r.repeat << "," << r.threads << "," << r.numIterations << "," << r.innerIterations << "," <<
+               (r.failed ? 1 : 0) << "," << s.warmup << "," << s.count << "," << s.mean << "," <<
+               s.min << "," << s.max << "," << s.median << "," << s.p5 << "," << s.p95 << "," <<
+               s.p99 << "," << s.mad << "," << s.ciLow << "," << s.ciHigh;
+        for( int e = 0; e < PerfCounters::EventCount; e++ )
+        {
+            out << ",";
+            writeCount(out, r.counterSummary.v[e], false);
+        }
+        out << ",";
+        if( r.ipc == r.ipc )
+            out << r.ipc;
+        out << "," << r.throughput << ",";
+        if( !r.allocSamples.empty() )
+            out << r.allocSummary.allocations << "," << r.allocSummary.bytes << "," << r.allocSummary.peak << "," <<
+                   r.allocationRate;
+        else
+            out << ",,,";
+        out << std::endl;
+    }
+}
+
+void Report::writeSamplesCsv(std::ostream& out) const
+{
+    out << std::fixed << std::setprecision(3);
+    out << "benchmark,allocator,repeat,threads,iteration,warmup,time_us";
+    for( int e = 0; e < PerfCounters::EventCount; e++ )
+        out << "," << PerfCounters::name(e);
+    out << ",allocations,alloc_bytes,peak_live_bytes" << std::endl;
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        const Record& r = records[i];
+        for( int j = 0; j < (int)r.samples.size(); j++ )
+        {
+            out << r.name << "," << r.allocator << "," << r.repeat << "," << r.threads << "," << j << "," << (j < r.summary.warmup ? 1 : 0) << "," <<
+                   r.samples[j];
+            for( int e = 0; e < PerfCounters::EventCount; e++ )
+            {
+                out << ",";
+                if( j < (int)r.counterSamples.size() )
+                    writeCount(out, r.counterSamples[j].v[e], false);
+            }
+            if( j < (int)r.allocSamples.size() )
+                out << "," << r.allocSamples[j].allocations << "," << r.allocSamples[j].bytes << "," <<
+                       r.allocSamples[j].peak;
+            else
+                out << ",,,";
+            out << std::endl;
+        }
+    }
+}
+
+bool Report::write(const std::string& path, void (Report::*writer)(std::ostream&) const) const
+{
+    if( path == "-" )
+    {
+        const std::ios::fmtflags flags = std::cout.flags();
+        const std::streamsize precision = std::cout.precision();
+        (this->*writer)(std::cout);
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+        return true;
+    }
+    std::ofstream out(path.c_str());
+    if( !out )
+        return false;
+    (this->*writer)(out);
+    return out.good();
+}
@@ -0,0 +1,75 @@
+#ifndef _REPORT_H
+#define _REPORT_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "Statistics.h"
+#include "PerfCounters.h"
+#include "AllocStats.h"
+
+class Run;
+
+// Collects the results of all runs of a session and writes them in machine readable
+// form; the human readable output remains the one of Run::reportBenchmark.
+class Report {
+public:
+    struct Record {
+        std::string name;
+        std::string allocator;
+        int repeat;
+        int numIterations;
+        int innerIterations;
+        bool failed;
+        std::vector<double> samples; // us
+        Statistics::Summary summary;
+        bool hasCounters;
+        std::vector<PerfCounters::Values> counterSamples;
+        PerfCounters::Values counterSummary;
+        double ipc;
+        std::vector<AllocStats::Sample> allocSamples; // empty unless AllocStats::enabled()
+        AllocStats::Sample allocSummary;
+        double allocationRate;
+        int threads; // 0 unless measured by Run::runThroughput
+        double throughput; // benchmark iterations per second
+        std::vector<Statistics::Summary> threadSummaries;
+    };
+
+    void add(const Run&, int repeat);
+    const std::vector<Record>& getRecords() const { return records; }
+
+    // one object per run with summary and samples
+    void writeJson(std::ostream&) const;
+    // one line per run
+    void writeCsv(std::ostream&) const;
+    // one line per sample
+    void writeSamplesCsv(std::ostream&) const;
+
+    // writes to the file at path or to stdout if path is "-"; returns false on error
+    bool write(const std::string& path, void (Report::*writer)(std::ostream&) const) const;
+private:
+    std::vector<Record> records;
+};
+
+#endif // _REPORT_H
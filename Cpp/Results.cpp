@@ -0,0 +1,329 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Results.h"
+#include "Report.h"
+#include "Statistics.h"
+#include "Object.h"
+#include "AllocStats.h"
+#include "som/Interfaces.h"
+#include "som/FlatDictionary.h"
+#include "BTree.h"
+#include "JsonParser.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#else
+#include <unistd.h>
+#endif
+
+static const char* s_magic = "awfy1";
+
+// fields are tab separated, so tabs and line breaks must not occur inside them
+static std::string field(const std::string& str)
+{
+    std::string res = str;
+    for( int i = 0; i < (int)res.size(); i++ )
+    {
+        if( res[i] == '\t' || res[i] == '\n' || res[i] == '\r' )
+            res[i] = ' ';
+    }
+    return res;
+}
+
+static std::string command(const char* cmd)
+{
+    FILE* f = popen(cmd, "r");
+    if( f == 0 )
+        return std::string();
+    std::string res;
+    char buf[256];
+    while( fgets(buf, sizeof(buf), f) )
+        res += buf;
+    pclose(f);
+    while( !res.empty() && (res[res.size()-1] == '\n' || res[res.size()-1] == '\r') )
+        res.erase(res.size() - 1);
+    return res;
+}
+
+std::string Results::revision()
+{
+    const char* env = getenv("AWFY_REVISION");
+    if( env )
+        return env;
+#if defined(_WIN32)
+    const std::string rev = command("git describe --always --dirty 2>NUL");
+#else
+    const std::string rev = command("git describe --always --dirty 2>/dev/null");
+#endif
+    return rev.empty() ? "unknown" : rev;
+}
+
+std::string Results::compiler()
+{
+    std::ostringstream out;
+#if defined(__clang__)
+    out << "clang " << __clang_version__;
+#elif defined(__GNUC__)
+    out << "gcc " << __VERSION__;
+#elif defined(_MSC_VER)
+    out << "msvc " << _MSC_FULL_VER;
+#else
+    out << "unknown";
+#endif
+    return out.str();
+}
+
+std::string Results::flags()
+{
+    std::ostringstream out;
+    out << "c++" << __cplusplus;
+#if defined(__OPTIMIZE__)
+    out << " optimized";
+#elif defined(__GNUC__)
+    out << " unoptimized";
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+    out << " x86_64";
+#elif defined(__i386__) || defined(_M_IX86)
+    out << " x86";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    out << " aarch64";
+#endif
+#ifdef __FAST_MATH__
+    out << " fast-math";
+#endif
+#ifdef NDEBUG
+    out << " NDEBUG";
+#endif
+#if defined(AWFY_REFCOUNT_NONE)
+    out << " AWFY_REFCOUNT_NONE";
+#elif defined(AWFY_REFCOUNT_ATOMIC)
+    out << " AWFY_REFCOUNT_ATOMIC";
+#endif
+#ifdef AWFY_ALLOC_STATS
+    out << " AWFY_ALLOC_STATS";
+#endif
+#ifdef SOM_VIRTUAL_DISPATCH
+    out << " SOM_VIRTUAL_DISPATCH";
+#endif
+#ifdef SOM_CHAINED_DICTIONARY
+    out << " SOM_CHAINED_DICTIONARY";
+#endif
+#ifdef CD_USE_BTREE
+    out << " CD_USE_BTREE";
+#endif
+#ifdef JSON_PURE_STRING_PARSER
+    out << " JSON_PURE_STRING_PARSER";
+#endif
+#ifdef AWFY_BUILD_FLAGS
+    out << " " << AWFY_BUILD_FLAGS;
+#endif
+    return out.str();
+}
+
+std::string Results::host()
+{
+#if defined(_WIN32)
+    const char* name = getenv("COMPUTERNAME");
+    return name ? name : "unknown";
+#else
+    char name[256];
+    if( gethostname(name, sizeof(name)) != 0 )
+        return "unknown";
+    name[sizeof(name) - 1] = 0;
+    return name;
+#endif
+}
+
+bool Results::append(const std::string& path, const Report& report, std::string& error)
+{
+    char session[32];
+    const time_t now = time(0);
+    strftime(session, sizeof(session), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    std::ofstream out(path.c_str(), std::ios::app);
+    if( !out )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    out << std::fixed << std::setprecision(3);
+    const std::string key = std::string(session) + "\t" + field(revision()) + "\t" + field(compiler()) + "\t" +
+            field(flags()) + "\t" + field(host());
+    const std::vector<Report::Record>& records = report.getRecords();
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        const Report::Record& r = records[i];
+        if( r.failed )
+            continue;
+        out << s_magic << "\t" << key << "\t" << field(r.name) << "\t" << field(r.allocator) << "\t" <<
+               r.threads << "\t" << r.innerIterations << "\t";
+        for( int j = r.summary.warmup; j < (int)r.samples.size(); j++ )
+            out << (j != r.summary.warmup ? "," : "") << r.samples[j];
+        out << std::endl;
+    }
+    if( !out.good() )
+    {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool Results::load(const std::string& path, std::vector<Entry>& entries, std::string& error)
+{
+    std::ifstream in(path.c_str());
+    if( !in )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    int lineNr = 0;
+    while( std::getline(in, line) )
+    {
+        lineNr++;
+        if( line.empty() || line[0] == '#' )
+            continue;
+        std::vector<std::string> fields;
+        std::string::size_type pos = 0;
+        while( true )
+        {
+            const std::string::size_type tab = line.find('\t', pos);
+            fields.push_back(line.substr(pos, tab == std::string::npos ? std::string::npos : tab - pos));
+            if( tab == std::string::npos )
+                break;
+            pos = tab + 1;
+        }
+        if( fields.size() != 11 || fields[0] != s_magic )
+        {
+            std::ostringstream msg;
+            msg << path << ":" << lineNr << ": invalid line";
+            error = msg.str();
+            return false;
+        }
+        Entry e;
+        e.session = fields[1];
+        e.revision = fields[2];
+        e.compiler = fields[3];
+        e.flags = fields[4];
+        e.host = fields[5];
+        e.benchmark = fields[6];
+        e.allocator = fields[7];
+        e.threads = atoi(fields[8].c_str());
+        e.innerIterations = atoi(fields[9].c_str());
+        const char* p = fields[10].c_str();
+        while( *p )
+        {
+            char* end;
+            e.samples.push_back(strtod(p, &end));
+            if( end == p )
+                break;
+            p = *end == ',' ? end + 1 : end;
+        }
+        entries.push_back(e);
+    }
+    return true;
+}
+
+std::vector<Results::Entry> Results::select(const std::vector<Entry>& entries, const std::string& spec)
+{
+    std::string session;
+    for( int i = 0; i < (int)entries.size(); i++ )
+    {
+        const Entry& e = entries[i];
+        if( spec == "last" || e.session == spec || e.revision.compare(0, spec.size(), spec) == 0 )
+            session = e.session;
+    }
+    std::vector<Entry> res;
+    for( int i = 0; i < (int)entries.size(); i++ )
+    {
+        if( !session.empty() && entries[i].session == session )
+            res.push_back(entries[i]);
+    }
+    return res;
+}
+
+int Results::compare(const Report& report, const std::vector<Entry>& baseline, double alpha, std::ostream& out)
+{
+    if( baseline.empty() )
+        return 0;
+    const Entry& b0 = baseline.front();
+    out << "Comparison with session " << b0.session << " revision " << b0.revision << std::endl;
+    out << "  baseline: " << b0.compiler << ", " << b0.flags << ", " << b0.host << std::endl;
+    out << "  current:  " << compiler() << ", " << flags() << ", " << host() << std::endl;
+
+    const std::ios::fmtflags fmt = out.flags();
+    out << std::fixed << std::setprecision(3) << std::left;
+    out << std::setw(16) << "benchmark" << std::setw(10) << "allocator" << std::setw(8) << "threads" <<
+           std::setw(16) << "baseline us" << std::setw(16) << "current us" << std::setw(10) << "change" <<
+           std::setw(10) << "p-value" << std::setw(8) << "delta" << "verdict" << std::endl;
+    int regressions = 0;
+    const std::vector<Report::Record>& records = report.getRecords();
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        const Report::Record& r = records[i];
+        if( r.failed )
+            continue;
+        const Entry* b = 0;
+        for( int j = 0; j < (int)baseline.size() && b == 0; j++ )
+        {
+            const Entry& e = baseline[j];
+            if( e.benchmark == r.name && e.allocator == r.allocator && e.threads == r.threads &&
+                    e.innerIterations == r.innerIterations )
+                b = &e;
+        }
+        if( b == 0 || b->samples.empty() )
+            continue;
+        const std::vector<double> current(r.samples.begin() + r.summary.warmup, r.samples.end());
+        double delta;
+        const double p = Statistics::mannWhitney(current, b->samples, delta);
+        const double before = Statistics::median(b->samples);
+        const double after = r.summary.median;
+        const char* verdict = "-";
+        if( p < alpha )
+        {
+            if( after > before )
+            {
+                verdict = "REGRESSION";
+                regressions++;
+            }else
+                verdict = "improvement";
+        }
+        std::ostringstream change;
+        change << std::fixed << std::setprecision(1) << std::showpos << (before > 0 ? (after / before - 1.0) * 100.0 : 0) << "%";
+        std::ostringstream pv;
+        pv << std::setprecision(2) << p;
+        out << std::setw(16) << r.name << std::setw(10) << r.allocator << std::setw(8) << r.threads <<
+               std::setw(16) << before << std::setw(16) << after << std::setw(10) << change.str() <<
+               std::setw(10) << pv.str() << std::setw(8) << std::setprecision(2) << delta << std::setprecision(3) <<
+               verdict << std::endl;
+    }
+    out.flags(fmt);
+    return regressions;
+}
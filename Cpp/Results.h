@@ -0,0 +1,68 @@
+#ifndef _RESULTS_H
+#define _RESULTS_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+class Report;
+
+// A results file keeps the steady state samples of earlier sessions, one line per
+// run, keyed by session (time stamp), revision, compiler, flags and host, so that
+// a later session can be compared with one of them.
+class Results {
+public:
+    struct Entry {
+        std::string session;
+        std::string revision;
+        std::string compiler;
+        std::string flags;
+        std::string host;
+        std::string benchmark;
+        std::string allocator;
+        int threads;
+        int innerIterations;
+        std::vector<double> samples; // us, without the warmup
+    };
+
+    // the git revision of the working directory, or the AWFY_REVISION environment variable
+    static std::string revision();
+    static std::string compiler();
+    // compile switches relevant to the results, plus AWFY_BUILD_FLAGS if defined by the build
+    static std::string flags();
+    static std::string host();
+
+    static bool append(const std::string& path, const Report&, std::string& error);
+    static bool load(const std::string& path, std::vector<Entry>& entries, std::string& error);
+
+    // the entries of the latest session whose time stamp equals spec or whose revision
+    // starts with spec; "last" selects the latest session
+    static std::vector<Entry> select(const std::vector<Entry>& entries, const std::string& spec);
+
+    // compares the records of the report with the baseline and prints one line per
+    // benchmark; returns the number of significant regressions
+    static int compare(const Report&, const std::vector<Entry>& baseline, double alpha, std::ostream&);
+};
+
+#endif // _RESULTS_H
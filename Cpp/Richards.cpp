@@ -9,6 +9,7 @@
  */
 
 #include "Richards.h"
+#include "Registry.h"
 #include "Object.h"
 #include <string>
 #include <sstream>
@@ -598,3 +599,4 @@ int Richards::benchmark()
     return res;
 }
 
+static Registration<Richards> registration("Richards", Registry::Macro, 100, 1);
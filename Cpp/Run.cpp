@@ -22,97 +22,34 @@
  */
 
 #include "Run.h"
-#include <time.h>
+#include "Clock.h"
 #include <stdio.h>
-#include "Bounce.h"
-#include "List.h"
-#include "Mandelbrot.h"
-#include "Permute.h"
-#include "Queens.h"
-#include "Sieve.h"
-#include "Storage.h"
-#include "Towers.h"
-#include "NBody.h"
-#include "Richards.h"
-#include "Json.h"
-#include "CD.h"
-#include "Havlak.h"
-#include "DeltaBlue.h"
-
-#if defined(_WIN32) && !defined(__GNUC__)
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
-
-// Source: https://stackoverflow.com/questions/10905892/equivalent-of-gettimeday-for-windows/26085827
-
-// MSVC defines this in winsock2.h!?
-typedef struct timeval {
-    long tv_sec;
-    long tv_usec;
-} timeval;
-
-int gettimeofday(struct timeval * tp, struct timezone * tzp)
-{
-    // Note: some broken versions only have 8 trailing zero's, the correct epoch has 9 trailing zero's
-    // This magic number is the number of 100 nanosecond intervals since January 1, 1601 (UTC)
-    // until 00:00:00 January 1, 1970
-    static const uint64_t EPOCH = ((uint64_t) 116444736000000000ULL);
-
-    SYSTEMTIME  system_time;
-    FILETIME    file_time;
-    uint64_t    time;
-
-    GetSystemTime( &system_time );
-    SystemTimeToFileTime( &system_time, &file_time );
-    time =  ((uint64_t)file_time.dwLowDateTime )      ;
-    time += ((uint64_t)file_time.dwHighDateTime) << 32;
-
-    tp->tv_sec  = (long) ((time - EPOCH) / 10000000L);
-    tp->tv_usec = (long) (system_time.wMilliseconds * 1000);
-    return 0;
-}
-#else
-#include <sys/time.h>
-#endif
+#include <string.h>
+#include <iomanip>
+#include <algorithm>
+#include <stdlib.h>
+#include "Registry.h"
+#include "Thread.h"
 
 
 Benchmark *Run::getSuiteFromName(const std::string &name)
 {
-    if( name == "Bounce" )
-        return new Bounce();
-    if( name == "List" )
-        return new List();
-    if( name == "Mandelbrot" )
-        return new Mandelbrot();
-    if( name == "Permute" )
-        return new Permute();
-    if( name == "Queens" )
-        return new Queens();
-    if( name == "Sieve" )
-        return new Sieve();
-    if( name == "Storage" )
-        return new Storage();
-    if( name == "Towers" )
-        return new Towers();
-    if( name == "NBody" )
-        return new NBody();
-    if( name == "Richards" )
-        return new Richards();
-    if( name == "Json" )
-        return new Json();
-    if( name == "CD" )
-        return new CD();
-    if( name == "Havlak" )
-        return new Havlak();
-    if( name == "DeltaBlue" )
-        return new DeltaBlue();
-    return 0;
+    const Registry::Info* info = Registry::find(name);
+    if( info == 0 )
+        return 0;
+    return info->create();
 }
 
-Run::Run(const std::string &name):numIterations(0),innerIterations(0),total(0)
+Run::Run(const std::string &name, Allocator* allocator):numIterations(0),innerIterations(0),total(0),warmup(AUTO_WARMUP),
+    failed(false),counters(0),threads(0)
 {
     this->name = name;
+    previousAllocator = Allocator::current();
+    this->allocator = allocator ? allocator : previousAllocator;
+    Allocator::setCurrent(this->allocator);
     this->benchmarkSuite = getSuiteFromName(name);
+    if( benchmarkSuite )
+        benchmarkSuite->setRandom(&random);
     numIterations   = 1;
     innerIterations = 1;
 }
@@ -121,6 +58,20 @@ Run::~Run()
 {
     if( benchmarkSuite )
         delete benchmarkSuite;
+    if( counters )
+        delete counters;
+    Allocator::setCurrent(previousAllocator);
+}
+
+bool Run::enableCounters(std::string& error)
+{
+    if( counters == 0 )
+        counters = new PerfCounters();
+    if( counters->open(error) )
+        return true;
+    delete counters;
+    counters = 0;
+    return false;
 }
 
 void Run::runBenchmark()
@@ -132,7 +83,10 @@ void Run::runBenchmark()
     }
 
     // Checkstyle: stop
-    std::cout << "Starting " << name << " benchmark ..." << std::endl;
+    std::cout << "Starting " << name << " benchmark";
+    if( strcmp(allocator->name(), "system") != 0 )
+        std::cout << " with the " << allocator->name() << " allocator";
+    std::cout << " ..." << std::endl;
     // Checkstyle: resume
 
     doRuns(benchmarkSuite);
@@ -143,41 +97,291 @@ void Run::runBenchmark()
     // Checkstyle: resume
 }
 
+struct ThroughputWorker {
+    Run* run;
+    int cpu;
+    bool pinned;
+    bool failed;
+    Barrier* barrier;
+    std::vector<Clock::Ticks> starts;
+    std::vector<Clock::Ticks> stops;
+};
+
+void Run::throughputWorker(void* arg)
+{
+    ThroughputWorker* w = (ThroughputWorker*)arg;
+    if( w->cpu >= 0 )
+        w->pinned = Thread::pinCurrent(w->cpu);
+    Allocator* allocator = w->run->allocator;
+    if( !allocator->isThreadSafe() )
+        allocator = Allocator::create(allocator->name());
+    Allocator::setCurrent(allocator);
+    // each thread has its own instance, allocated after pinning, so that it is in local memory
+    Benchmark* bench = getSuiteFromName(w->run->name);
+    som::Random random;
+    bench->setRandom(&random);
+    Clock* clock = Clock::current();
+    for( int i = 0; i < w->run->numIterations; i++ )
+    {
+        w->barrier->wait();
+        allocator->beginSample();
+        const Clock::Ticks start = clock->start();
+        bool ok = false;
+        if( !w->failed )
+        {
+            try
+            {
+                ok = bench->innerBenchmarkLoop(w->run->innerIterations);
+            }catch(...)
+            {
+            }
+        }
+        const Clock::Ticks end = clock->stop();
+        bench->endSample();
+        allocator->endSample();
+        if( !ok )
+            w->failed = true; // keep going, the other threads wait for us in the barrier
+        w->starts[i] = start;
+        w->stops[i] = end;
+    }
+    delete bench;
+    Allocator::setCurrent(0);
+    if( allocator != w->run->allocator )
+        delete allocator;
+}
+
+void Run::runThroughput(int threads, const std::vector<int>& cpus)
+{
+    if( benchmarkSuite == 0 )
+    {
+        std::cerr << "ERROR unknown benchmark "<< name << std::endl;
+        throw "";
+    }
+
+    // Checkstyle: stop
+    std::cout << "Starting " << name << " benchmark with " << threads << " threads";
+    if( strcmp(allocator->name(), "system") != 0 )
+        std::cout << " and the " << allocator->name() << " allocator";
+    std::cout << " ..." << std::endl;
+    // Checkstyle: resume
+
+    this->threads = threads;
+    Barrier barrier(threads);
+    std::vector<ThroughputWorker> workers(threads);
+    Thread* pool = new Thread[threads];
+    for( int t = 0; t < threads; t++ )
+    {
+        ThroughputWorker& w = workers[t];
+        w.run = this;
+        w.cpu = cpus.empty() ? -1 : cpus[t % cpus.size()];
+        w.pinned = false;
+        w.failed = false;
+        w.barrier = &barrier;
+        w.starts.resize(numIterations);
+        w.stops.resize(numIterations);
+    }
+    int started = 0;
+    while( started < threads && pool[started].start(throughputWorker, &workers[started]) )
+        started++;
+    if( started < threads )
+    {
+        // the started threads would wait forever in the barrier
+        std::cerr << "ERROR cannot start thread " << started << std::endl;
+        abort();
+    }
+    delete[] pool; // joins
+
+    Clock* clock = Clock::current();
+    samples.assign(numIterations, 0);
+    threadSamples.assign(threads, std::vector<double>(numIterations));
+    total = 0;
+    for( int i = 0; i < numIterations; i++ )
+    {
+        Clock::Ticks start = workers[0].starts[i], stop = workers[0].stops[i];
+        for( int t = 0; t < threads; t++ )
+        {
+            const ThroughputWorker& w = workers[t];
+            start = std::min(start, w.starts[i]);
+            stop = std::max(stop, w.stops[i]);
+            threadSamples[t][i] = clock->toMicroseconds(w.stops[i] - w.starts[i]);
+        }
+        samples[i] = clock->toMicroseconds(stop - start);
+        total += samples[i];
+    }
+
+    int discard = warmup;
+    if( discard == AUTO_WARMUP )
+        discard = Statistics::detectWarmup(samples);
+    summary = Statistics::summarize(samples, discard);
+    threadSummaries.resize(threads);
+    for( int t = 0; t < threads; t++ )
+    {
+        threadSummaries[t] = Statistics::summarize(threadSamples[t], summary.warmup);
+        if( workers[t].failed )
+        {
+            std::cerr << "Benchmark failed with incorrect result on thread " << t << std::endl;
+            failed = true;
+        }
+        if( workers[t].cpu >= 0 && !workers[t].pinned )
+            std::cerr << "WARNING: cannot pin thread " << t << " to CPU " << workers[t].cpu << std::endl;
+    }
+
+    reportThroughput(cpus);
+
+    // Checkstyle: stop
+    std::cout << std::endl;
+    // Checkstyle: resume
+}
+
+double Run::getAllocationRate() const
+{
+    if( summary.median <= 0 )
+        return 0;
+    return allocSummary.allocations * 1.0e6 / summary.median;
+}
+
+double Run::getThroughput() const
+{
+    if( summary.median <= 0 )
+        return 0;
+    return std::max(threads, 1) * innerIterations * 1.0e6 / summary.median;
+}
+
 void Run::measure(Benchmark *bench)
 {
-    struct timeval start, end;
-    gettimeofday(&start, 0);
+    Clock* clock = Clock::current();
+    allocator->beginSample();
+    const AllocStats::Counters allocs = AllocStats::begin();
+    if( counters )
+        counters->start();
+    const Clock::Ticks start = clock->start();
     if (!bench->innerBenchmarkLoop(innerIterations)) {
+        if( counters )
+            counters->stop();
+        bench->endSample();
+        allocator->endSample();
         std::cerr << "Benchmark failed with incorrect result" << std::endl;
+        failed = true;
         return;
     }
-    gettimeofday(&end, 0);
-    const long seconds = end.tv_sec - start.tv_sec;
-    const long microseconds = end.tv_usec - start.tv_usec;
-    const long runTime = seconds*1000000 + microseconds; // us
+    const Clock::Ticks end = clock->stop();
+    if( counters )
+        counterSamples.push_back(counters->stop());
+    if( AllocStats::enabled() )
+        allocSamples.push_back(AllocStats::end(allocs));
+    bench->endSample();
+    allocator->endSample();
+    const double runTime = clock->toMicroseconds(end - start); // us
 
     printResult(runTime);
 
+    samples.push_back(runTime);
+
     total += runTime;
 }
 
 void Run::doRuns(Benchmark *bench)
 {
+    samples.clear();
+    samples.reserve(numIterations);
+    counterSamples.clear();
+    if( counters )
+        counterSamples.reserve(numIterations);
+    allocSamples.clear();
+    if( AllocStats::enabled() )
+        allocSamples.reserve(numIterations);
     for (int i = 0; i < numIterations; i++) {
         measure(bench);
     }
+    int discard = warmup;
+    if( discard == AUTO_WARMUP )
+        discard = Statistics::detectWarmup(samples);
+    summary = Statistics::summarize(samples, discard);
+    if( counters )
+        counterSummary = PerfCounters::median(counterSamples, summary.warmup);
+    allocSummary = AllocStats::summarize(allocSamples, summary.warmup);
 }
 
 void Run::reportBenchmark()
 {
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3);
+
     // Checkstyle: stop
     std::cout << name << ": iterations=" << numIterations <<
                  " average: " << (total / numIterations) << "us total: " << total << "us" << std::endl;
+    std::cout << name << ": warmup=" << summary.warmup << " samples=" << summary.count <<
+                 " median: " << summary.median << "us p5: " << summary.p5 << "us p95: " << summary.p95 <<
+                 "us p99: " << summary.p99 << "us MAD: " << summary.mad <<
+                 "us 95% CI: [" << summary.ciLow << ", " << summary.ciHigh << "]us" << std::endl;
+    const std::string extra = benchmarkSuite->report(summary.median);
+    if( !extra.empty() )
+        std::cout << name << ": " << extra << std::endl;
+    if( counters )
+    {
+        std::cout << name << ": counters (median per sample)";
+        for( int e = 0; e < PerfCounters::EventCount; e++ )
+        {
+            if( counterSummary.has(e) )
+                std::cout << " " << PerfCounters::name(e) << ": " << std::setprecision(0) << counterSummary.v[e];
+        }
+        const double ipc = getIpc();
+        if( ipc == ipc )
+            std::cout << " IPC: " << std::setprecision(3) << ipc;
+        std::cout << std::endl;
+    }
+    if( AllocStats::enabled() )
+    {
+        std::cout << name << ": allocations (median per sample): " << allocSummary.allocations <<
+                     " bytes: " << allocSummary.bytes << " peak live: " << allocSummary.peak <<
+                     " deallocations: " << allocSummary.deallocations << " rate: " << getAllocationRate() << "/s" << std::endl;
+        std::cout << name << ": size classes (bytes, count after warmup)";
+        for( int c = 0; c < AllocStats::SIZE_CLASSES; c++ )
+        {
+            if( allocSummary.histogram[c] == 0 )
+                continue;
+            if( c == AllocStats::SIZE_CLASSES - 1 )
+                std::cout << " >" << AllocStats::sizeClassLimit(c - 1);
+            else
+                std::cout << " <=" << AllocStats::sizeClassLimit(c);
+            std::cout << ": " << allocSummary.histogram[c];
+        }
+        std::cout << std::endl;
+    }
+    // Checkstyle: resume
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+}
+
+void Run::reportThroughput(const std::vector<int>& cpus)
+{
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3);
+
+    // Checkstyle: stop
+    std::cout << name << ": threads=" << threads << " rounds=" << numIterations << " warmup=" << summary.warmup <<
+                 " round median: " << summary.median << "us p95: " << summary.p95 <<
+                 "us throughput: " << getThroughput() << "/s" << std::endl;
+    for( int t = 0; t < threads; t++ )
+    {
+        const Statistics::Summary& s = threadSummaries[t];
+        std::cout << name << ": thread " << t;
+        if( !cpus.empty() )
+            std::cout << " (CPU " << cpus[t % cpus.size()] << ")";
+        std::cout << " median: " << s.median << "us p95: " << s.p95 << "us throughput: " <<
+                     (s.median > 0 ? innerIterations * 1.0e6 / s.median : 0) << "/s" << std::endl;
+    }
     // Checkstyle: resume
 
+    std::cout.flags(flags);
+    std::cout.precision(precision);
 }
 
-void Run::printResult(long runTime)
+void Run::printResult(double runTime)
 {
 #if 0
     // Checkstyle: stop
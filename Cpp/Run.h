@@ -25,25 +25,53 @@
  */
 
 #include <string>
+#include <vector>
 #include <iostream>
 #include <Benchmark.h>
+#include "Statistics.h"
+#include "PerfCounters.h"
+#include "AllocStats.h"
+#include "Allocator.h"
 
 class Run {
     std::string name;
     Benchmark* benchmarkSuite;
+    som::Random random; // given to benchmarkSuite
+    Allocator* allocator; // current while the Run exists
+    Allocator* previousAllocator;
     int numIterations;
     int innerIterations;
-    long total;
+    double total; // us
+    int warmup;
+    bool failed;
+    std::vector<double> samples; // us, one per measure()
+    Statistics::Summary summary;
+    PerfCounters* counters; // 0 unless enabled and available
+    std::vector<PerfCounters::Values> counterSamples; // one per measure()
+    PerfCounters::Values counterSummary; // medians of the samples after the warmup
+    std::vector<AllocStats::Sample> allocSamples; // one per measure() if AllocStats::enabled()
+    AllocStats::Sample allocSummary;
+    int threads; // 0 unless run by runThroughput
+    std::vector<std::vector<double> > threadSamples; // us, per thread and round
+    std::vector<Statistics::Summary> threadSummaries;
 
     static Benchmark* getSuiteFromName(const std::string& name);
 
 public:
-    Run(const std::string& name);
+    // allocator becomes the current one of the thread until the Run is deleted; it
+    // must outlive the Run, and in the throughput mode it is shared by the threads if
+    // it is thread safe, otherwise each thread creates its own of the same kind
+    Run(const std::string& name, Allocator* allocator = 0);
     ~Run();
     void runBenchmark();
 
     void printTotal();
 
+    // Runs the given number of independent benchmark instances concurrently, each on its
+    // own thread (pinned to cpus[i % cpus.size()] if cpus is not empty); the threads start
+    // each of the numIterations rounds together. The samples are the wall times of the rounds.
+    void runThroughput(int threads, const std::vector<int>& cpus);
+
     void setNumIterations(int numIterations) {
         this->numIterations = numIterations;
     }
@@ -51,6 +79,37 @@ public:
     void setInnerIterations(int innerIterations) {
         this->innerIterations = innerIterations;
     }
+
+    // number of leading samples to discard, or AUTO_WARMUP to detect the steady state
+    enum { AUTO_WARMUP = -1 };
+    void setWarmup(int warmup) {
+        this->warmup = warmup;
+    }
+
+    // count hardware events around each sample; returns false with the reason if
+    // the counters are not available, in which case only the time is measured
+    bool enableCounters(std::string& error);
+
+    const std::string& getName() const { return name; }
+    const char* getAllocatorName() const { return allocator->name(); }
+    int getNumIterations() const { return numIterations; }
+    int getInnerIterations() const { return innerIterations; }
+    double getTotal() const { return total; }
+    bool hasFailed() const { return failed; }
+    const std::vector<double>& getSamples() const { return samples; }
+    const Statistics::Summary& getSummary() const { return summary; }
+    bool hasCounters() const { return counters != 0; }
+    const std::vector<PerfCounters::Values>& getCounterSamples() const { return counterSamples; }
+    const PerfCounters::Values& getCounterSummary() const { return counterSummary; }
+    double getIpc() const { return PerfCounters::ipc(counterSamples, summary.warmup); }
+    const std::vector<AllocStats::Sample>& getAllocSamples() const { return allocSamples; }
+    const AllocStats::Sample& getAllocSummary() const { return allocSummary; }
+    // allocations per second based on the medians, 0 if not enabled
+    double getAllocationRate() const;
+    int getThreads() const { return threads; }
+    const std::vector<Statistics::Summary>& getThreadSummaries() const { return threadSummaries; }
+    // benchmark iterations per second of all threads, based on the median sample
+    double getThroughput() const;
 private:
     void measure(Benchmark* bench);
 
@@ -58,7 +117,11 @@ private:
 
     void reportBenchmark();
 
-    void printResult(long runTime);
+    void reportThroughput(const std::vector<int>& cpus);
+
+    static void throughputWorker(void* arg);
+
+    void printResult(double runTime);
 
 };
 
@@ -22,6 +22,7 @@
  */
 
 #include "Sieve.h"
+#include "Registry.h"
 
 int Sieve::benchmark()
 {
@@ -50,3 +51,5 @@ int Sieve::sieve(bool *flags, int size)
     }
     return primeCount;
 }
+
+static Registration<Sieve> registration("Sieve", Registry::Micro, 3000, 1);
@@ -0,0 +1,107 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Sort.h"
+#include "Registry.h"
+#include "Thread.h"
+#include "som/Vector.h"
+using namespace som;
+
+struct Item {
+    int key;
+    int id;
+    Item(int k = 0, int i = 0):key(k),id(i) {}
+};
+
+namespace som {
+SOM_RELOCATABLE(Item)
+}
+
+struct IntCompare {
+    int operator()(int lhs, int rhs) const { return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0); }
+};
+
+struct DoubleCompare {
+    int operator()(double lhs, double rhs) const { return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0); }
+};
+
+struct ItemCompare {
+    int operator()(const Item& lhs, const Item& rhs) const { return lhs.key - rhs.key; }
+};
+
+// well above Sorter::PARALLEL_LIMIT, so that ParallelSort splits into a few dozen tasks
+enum { SIZE = 100000 };
+
+template<class E, class F>
+static bool sortAndCheck(Vector<E>& v, F c, ThreadPool* pool)
+{
+    if( pool )
+        v.sort(c, *pool);
+    else
+        v.sort(c);
+    for( int i = 1; i < v.size(); i++ )
+    {
+        if( c(v.at(i - 1), v.at(i)) > 0 )
+            return false;
+    }
+    return true;
+}
+
+int Sort::benchmark()
+{
+    som::Random& random = this->random();
+    random.reset();
+    Vector<int> ints(SIZE);
+    Vector<double> doubles(SIZE);
+    Vector<Item> items(SIZE);
+    for( int i = 0; i < SIZE; i++ )
+    {
+        ints.append(random.next());
+        doubles.append(random.next() / 65536.0);
+        items.append(Item(random.next() % 100, i)); // many duplicates
+    }
+
+    if( !sortAndCheck(ints, IntCompare(), pool) || !sortAndCheck(doubles, DoubleCompare(), pool) ||
+            !sortAndCheck(items, ItemCompare(), pool) )
+        return -1;
+
+    double ids = 0; // the sum exceeds an int
+    for( int i = 0; i < SIZE; i++ )
+        ids += items.at(i).id;
+    if( ids != SIZE * (SIZE - 1.0) / 2 )
+        return -1;
+
+    return ints.at(0) + ints.at(SIZE / 2) + ints.at(SIZE - 1) + int(doubles.at(SIZE / 2) * 1000) +
+            items.at(SIZE / 2).key + items.at(SIZE - 1).key;
+}
+
+ParallelSort::ParallelSort()
+{
+    pool = new ThreadPool(Thread::cpuCount() - 1);
+}
+
+ParallelSort::~ParallelSort()
+{
+    delete pool;
+}
+
+static Registration<Sort> registration("Sort", Registry::Micro, 50, 1);
+static Registration<ParallelSort> registration2("ParallelSort", Registry::Micro, 50, 1);
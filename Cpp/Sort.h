@@ -0,0 +1,49 @@
+#ifndef _SORT_H
+#define _SORT_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+class ThreadPool;
+
+// Sorts vectors of random ints, doubles and small structs with som::Vector::sort;
+// ParallelSort does the same on a thread pool with a worker per additional CPU.
+class Sort : public Benchmark {
+public:
+    Sort():pool(0) {}
+    int benchmark();
+
+    bool verifyResult(int result) {
+        return 98882 == result;
+    }
+protected:
+    ThreadPool* pool;
+};
+
+class ParallelSort : public Sort {
+public:
+    ParallelSort();
+    ~ParallelSort();
+};
+
+#endif // _SORT_H
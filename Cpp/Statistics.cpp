@@ -0,0 +1,264 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Statistics.h"
+#include <algorithm>
+#include <math.h>
+
+// series shorter than this are considered too short for changepoint detection
+static const int MIN_WARMUP_SAMPLES = 10;
+
+// scale factor to make the MAD a consistent estimator of the standard deviation
+static const double MAD_TO_SIGMA = 1.4826;
+
+// work budget for the bootstrap, i.e. number of resamples times number of samples
+static const double BOOTSTRAP_WORK = 2.0e7;
+
+Statistics::Summary::Summary():count(0),warmup(0),mean(0),min(0),max(0),median(0),
+    p5(0),p95(0),p99(0),mad(0),ciLow(0),ciHigh(0)
+{
+}
+
+double Statistics::percentile(const std::vector<double>& sorted, double p)
+{
+    if( sorted.empty() )
+        return 0;
+    const double pos = p * (sorted.size() - 1);
+    const int lo = (int)floor(pos);
+    const int hi = (int)ceil(pos);
+    if( lo == hi )
+        return sorted[lo];
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+double Statistics::median(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    return percentile(samples, 0.5);
+}
+
+int Statistics::findChangepoint(const std::vector<double>& samples, int from, int to, double noise)
+{
+    // Single changepoint in mean by least squares (binary segmentation step); the split
+    // is only accepted if the cost reduction exceeds a BIC style penalty and the segment
+    // before the split is slower than the one after it.
+    const int n = to - from;
+    const int limit = std::min(to - 2, (int)samples.size() / 2);
+    if( n < MIN_WARMUP_SAMPLES || limit <= from )
+        return -1;
+
+    std::vector<double> sum(n + 1), sum2(n + 1);
+    sum[0] = sum2[0] = 0;
+    for( int i = 0; i < n; i++ )
+    {
+        const double x = samples[from + i];
+        sum[i+1] = sum[i] + x;
+        sum2[i+1] = sum2[i] + x * x;
+    }
+    const double total = sum2[n] - sum[n] * sum[n] / n;
+
+    int best = -1;
+    double bestCost = total;
+    for( int k = 1; from + k <= limit; k++ )
+    {
+        const double head = sum2[k] - sum[k] * sum[k] / k;
+        const double tail = (sum2[n] - sum2[k]) - (sum[n] - sum[k]) * (sum[n] - sum[k]) / (n - k);
+        if( head + tail < bestCost )
+        {
+            bestCost = head + tail;
+            best = k;
+        }
+    }
+    if( best < 0 )
+        return -1;
+
+    const double penalty = 2.0 * noise * log((double)samples.size());
+    if( total - bestCost <= penalty )
+        return -1;
+    const double headMean = sum[best] / best;
+    const double tailMean = (sum[n] - sum[best]) / (n - best);
+    if( headMean <= tailMean )
+        return -1;
+    return from + best;
+}
+
+int Statistics::detectWarmup(const std::vector<double>& samples)
+{
+    const int n = samples.size();
+    if( n < MIN_WARMUP_SAMPLES )
+        return 0;
+
+    // Center the series to keep the prefix sums well conditioned, and estimate the
+    // noise of the steady state from the second half, which is never discarded.
+    const double center = median(samples);
+    std::vector<double> centered(n);
+    for( int i = 0; i < n; i++ )
+        centered[i] = samples[i] - center;
+
+    std::vector<double> tail(centered.begin() + n / 2, centered.end());
+    const double tailMedian = median(tail);
+    std::vector<double> dev(tail.size());
+    double mean = 0;
+    for( int i = 0; i < (int)tail.size(); i++ )
+    {
+        dev[i] = fabs(tail[i] - tailMedian);
+        mean += tail[i];
+    }
+    mean /= tail.size();
+    const double sigma = MAD_TO_SIGMA * median(dev);
+    double noise = sigma * sigma;
+    if( noise == 0.0 )
+    {
+        // quantized timer or perfectly stable workload; fall back to the variance
+        for( int i = 0; i < (int)tail.size(); i++ )
+            noise += (tail[i] - mean) * (tail[i] - mean);
+        noise /= tail.size();
+    }
+    if( noise == 0.0 )
+        noise = 1e-12;
+
+    int warmup = 0;
+    while( true )
+    {
+        const int k = findChangepoint(centered, warmup, n, noise);
+        if( k <= warmup )
+            break;
+        warmup = k;
+    }
+    return warmup;
+}
+
+void Statistics::bootstrapMedian(const std::vector<double>& samples, double confidence,
+                                 double& low, double& high)
+{
+    const int n = samples.size();
+    if( n < 2 )
+    {
+        low = high = n ? samples[0] : 0;
+        return;
+    }
+    const int resamples = std::max(100, std::min(1000, (int)(BOOTSTRAP_WORK / n)));
+
+    // deterministic xorshift generator; som::Random must not be disturbed by the harness
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    std::vector<double> buf(n);
+    std::vector<double> medians(resamples);
+    for( int r = 0; r < resamples; r++ )
+    {
+        for( int i = 0; i < n; i++ )
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            buf[i] = samples[(state >> 11) % n];
+        }
+        std::vector<double>::iterator mid = buf.begin() + n / 2;
+        std::nth_element(buf.begin(), mid, buf.end());
+        if( n % 2 == 0 )
+            medians[r] = (*mid + *std::max_element(buf.begin(), mid)) / 2.0;
+        else
+            medians[r] = *mid;
+    }
+    std::sort(medians.begin(), medians.end());
+    low = percentile(medians, (1.0 - confidence) / 2.0);
+    high = percentile(medians, (1.0 + confidence) / 2.0);
+}
+
+Statistics::Summary Statistics::summarize(const std::vector<double>& samples, int warmup)
+{
+    Summary s;
+    if( warmup < 0 || warmup >= (int)samples.size() )
+        warmup = 0;
+    std::vector<double> steady(samples.begin() + warmup, samples.end());
+    s.warmup = warmup;
+    s.count = steady.size();
+    if( steady.empty() )
+        return s;
+
+    double sum = 0;
+    for( int i = 0; i < (int)steady.size(); i++ )
+        sum += steady[i];
+    s.mean = sum / steady.size();
+
+    std::vector<double> sorted = steady;
+    std::sort(sorted.begin(), sorted.end());
+    s.min = sorted.front();
+    s.max = sorted.back();
+    s.median = percentile(sorted, 0.5);
+    s.p5 = percentile(sorted, 0.05);
+    s.p95 = percentile(sorted, 0.95);
+    s.p99 = percentile(sorted, 0.99);
+
+    std::vector<double> dev(sorted.size());
+    for( int i = 0; i < (int)sorted.size(); i++ )
+        dev[i] = fabs(sorted[i] - s.median);
+    s.mad = median(dev);
+
+    bootstrapMedian(steady, 0.95, s.ciLow, s.ciHigh);
+    return s;
+}
+
+double Statistics::mannWhitney(const std::vector<double>& a, const std::vector<double>& b, double& delta)
+{
+    const int n1 = a.size();
+    const int n2 = b.size();
+    delta = 0;
+    if( n1 == 0 || n2 == 0 )
+        return 1.0;
+
+    // rank the pooled samples, ties get the average of their ranks
+    std::vector<std::pair<double,int> > pooled;
+    pooled.reserve(n1 + n2);
+    for( int i = 0; i < n1; i++ )
+        pooled.push_back(std::make_pair(a[i], 0));
+    for( int i = 0; i < n2; i++ )
+        pooled.push_back(std::make_pair(b[i], 1));
+    std::sort(pooled.begin(), pooled.end());
+    const int n = pooled.size();
+    double rankSumA = 0, ties = 0;
+    for( int i = 0; i < n; )
+    {
+        int j = i;
+        while( j < n && pooled[j].first == pooled[i].first )
+            j++;
+        const double rank = (i + 1 + j) / 2.0;
+        const double t = j - i;
+        ties += t * t * t - t;
+        for( int k = i; k < j; k++ )
+        {
+            if( pooled[k].second == 0 )
+                rankSumA += rank;
+        }
+        i = j;
+    }
+
+    const double u = rankSumA - n1 * (n1 + 1) / 2.0;
+    const double n1n2 = (double)n1 * n2;
+    delta = 2.0 * u / n1n2 - 1.0;
+    const double mean = n1n2 / 2.0;
+    const double var = n1n2 / 12.0 * ((n + 1) - ties / ((double)n * (n - 1)));
+    if( var <= 0 )
+        return 1.0;
+    double diff = fabs(u - mean) - 0.5; // continuity correction
+    if( diff < 0 )
+        diff = 0;
+    return erfc(diff / sqrt(var) / sqrt(2.0));
+}
@@ -0,0 +1,70 @@
+#ifndef _STATISTICS_H
+#define _STATISTICS_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <vector>
+
+// Descriptive statistics over the per-iteration samples collected by Run.
+// All values are in the unit of the samples (i.e. microseconds).
+class Statistics {
+public:
+    struct Summary {
+        int count;      // number of samples after discarding the warmup
+        int warmup;     // number of leading samples discarded as warmup
+        double mean;
+        double min;
+        double max;
+        double median;
+        double p5;
+        double p95;
+        double p99;
+        double mad;     // median absolute deviation from the median
+        double ciLow;   // bootstrap 95% confidence interval of the median
+        double ciHigh;
+        Summary();
+    };
+
+    // Returns the number of leading samples which belong to the warmup phase,
+    // i.e. the samples before the last significant changepoint in the first
+    // half of the series; returns 0 if the series looks stationary.
+    static int detectWarmup(const std::vector<double>& samples);
+
+    static Summary summarize(const std::vector<double>& samples, int warmup);
+
+    // p in [0,1], linear interpolation between closest ranks; sorted must be sorted.
+    static double percentile(const std::vector<double>& sorted, double p);
+
+    static double median(std::vector<double> samples);
+
+    static void bootstrapMedian(const std::vector<double>& samples, double confidence,
+                                double& low, double& high);
+
+    // Two sided Mann-Whitney U test (normal approximation with tie correction) whether
+    // a and b come from the same distribution; returns the p-value. delta is Cliff's
+    // delta, i.e. P(a > b) - P(a < b), in [-1,1].
+    static double mannWhitney(const std::vector<double>& a, const std::vector<double>& b, double& delta);
+private:
+    static int findChangepoint(const std::vector<double>& samples, int from, int to, double noise);
+};
+
+#endif // _STATISTICS_H
@@ -22,13 +22,13 @@
  */
 
 #include "Storage.h"
-#include "som/Random.h"
+#include "Registry.h"
 
 #ifdef _USE_STD_VECTOR_
 
 int Storage::benchmark()
 {
-    som::Random::reset();
+    random().reset();
     count = 0;
     Tree t;
     buildTreeDepth(7, &t);
@@ -39,7 +39,7 @@ void Storage::buildTreeDepth(int depth, Tree* out)
 {
     count++;
     if (depth == 1) {
-        const int len = som::Random::next() % 10 + 1;
+        const int len = random().next() % 10 + 1;
         out->subs.resize(len);
         for( int i = 0; i < len; i++ )
             out->subs[i] = new Tree();
@@ -58,7 +58,7 @@ void Storage::buildTreeDepth(int depth, Tree* out)
 
 int Storage::benchmark()
 {
-    som::Random::reset();
+    random().reset();
     count = 0;
     Tree* t = buildTreeDepth(7);
     delete[] t;
@@ -69,7 +69,7 @@ Storage::Tree *Storage::buildTreeDepth(int depth)
 {
     count++;
     if (depth == 1) {
-        const int len = som::Random::next() % 10 + 1;
+        const int len = random().next() % 10 + 1;
         return new Tree[len];
     } else {
         const int len = 4;
@@ -81,3 +81,5 @@ Storage::Tree *Storage::buildTreeDepth(int depth)
 }
 
 #endif
+
+static Registration<Storage> registration("Storage", Registry::Micro, 1000, 1);
@@ -0,0 +1,437 @@
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Thread.h"
+#include <stdlib.h>
+
+#if defined(_WIN32) && !defined(__GNUC__)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+struct Thread::Imp {
+    HANDLE handle;
+    Function function;
+    void* arg;
+};
+
+static DWORD WINAPI threadMain(LPVOID param)
+{
+    Thread::Imp* d = (Thread::Imp*)param;
+    d->function(d->arg);
+    return 0;
+}
+
+bool Thread::start(Function f, void* arg)
+{
+    d->function = f;
+    d->arg = arg;
+    d->handle = CreateThread(0, 0, threadMain, d, 0, 0);
+    return d->handle != 0;
+}
+
+void Thread::join()
+{
+    if( d->handle == 0 )
+        return;
+    WaitForSingleObject(d->handle, INFINITE);
+    CloseHandle(d->handle);
+    d->handle = 0;
+}
+
+bool Thread::pinCurrent(int cpu)
+{
+    if( cpu < 0 || cpu >= 64 )
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+}
+
+int Thread::cpuCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+}
+
+struct Mutex::Imp {
+    CRITICAL_SECTION lock;
+};
+
+Mutex::Mutex():d(new Imp())
+{
+    InitializeCriticalSection(&d->lock);
+}
+
+Mutex::~Mutex()
+{
+    DeleteCriticalSection(&d->lock);
+    delete d;
+}
+
+void Mutex::lock()
+{
+    EnterCriticalSection(&d->lock);
+}
+
+void Mutex::unlock()
+{
+    LeaveCriticalSection(&d->lock);
+}
+
+struct Condition::Imp {
+    CONDITION_VARIABLE cond;
+};
+
+Condition::Condition():d(new Imp())
+{
+    InitializeConditionVariable(&d->cond);
+}
+
+Condition::~Condition()
+{
+    delete d;
+}
+
+void Condition::wait(Mutex& m)
+{
+    SleepConditionVariableCS(&d->cond, &m.d->lock, INFINITE);
+}
+
+void Condition::signal()
+{
+    WakeConditionVariable(&d->cond);
+}
+
+void Condition::broadcast()
+{
+    WakeAllConditionVariable(&d->cond);
+}
+
+struct Barrier::Imp {
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE cond;
+};
+
+Barrier::Barrier(int count):d(new Imp()),count(count),waiting(0),generation(0)
+{
+    InitializeCriticalSection(&d->lock);
+    InitializeConditionVariable(&d->cond);
+}
+
+Barrier::~Barrier()
+{
+    DeleteCriticalSection(&d->lock);
+    delete d;
+}
+
+void Barrier::wait()
+{
+    EnterCriticalSection(&d->lock);
+    const unsigned int gen = generation;
+    if( ++waiting == count )
+    {
+        waiting = 0;
+        generation++;
+        WakeAllConditionVariable(&d->cond);
+    }else
+        while( gen == generation )
+            SleepConditionVariableCS(&d->cond, &d->lock, INFINITE);
+    LeaveCriticalSection(&d->lock);
+}
+
+#else
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+struct Thread::Imp {
+    pthread_t handle;
+    bool running;
+    Function function;
+    void* arg;
+};
+
+static void* threadMain(void* param)
+{
+    Thread::Imp* d = (Thread::Imp*)param;
+    d->function(d->arg);
+    return 0;
+}
+
+bool Thread::start(Function f, void* arg)
+{
+    d->function = f;
+    d->arg = arg;
+    d->running = pthread_create(&d->handle, 0, threadMain, d) == 0;
+    return d->running;
+}
+
+void Thread::join()
+{
+    if( !d->running )
+        return;
+    pthread_join(d->handle, 0);
+    d->running = false;
+}
+
+bool Thread::pinCurrent(int cpu)
+{
+#if defined(__linux__) && defined(CPU_SET)
+    if( cpu < 0 || cpu >= CPU_SETSIZE )
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+int Thread::cpuCount()
+{
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? n : 1;
+}
+
+struct Mutex::Imp {
+    pthread_mutex_t lock;
+};
+
+Mutex::Mutex():d(new Imp())
+{
+    pthread_mutex_init(&d->lock, 0);
+}
+
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy(&d->lock);
+    delete d;
+}
+
+void Mutex::lock()
+{
+    pthread_mutex_lock(&d->lock);
+}
+
+void Mutex::unlock()
+{
+    pthread_mutex_unlock(&d->lock);
+}
+
+struct Condition::Imp {
+    pthread_cond_t cond;
+};
+
+Condition::Condition():d(new Imp())
+{
+    pthread_cond_init(&d->cond, 0);
+}
+
+Condition::~Condition()
+{
+    pthread_cond_destroy(&d->cond);
+    delete d;
+}
+
+void Condition::wait(Mutex& m)
+{
+    pthread_cond_wait(&d->cond, &m.d->lock);
+}
+
+void Condition::signal()
+{
+    pthread_cond_signal(&d->cond);
+}
+
+void Condition::broadcast()
+{
+    pthread_cond_broadcast(&d->cond);
+}
+
+struct Barrier::Imp {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+Barrier::Barrier(int count):d(new Imp()),count(count),waiting(0),generation(0)
+{
+    pthread_mutex_init(&d->lock, 0);
+    pthread_cond_init(&d->cond, 0);
+}
+
+Barrier::~Barrier()
+{
+    pthread_cond_destroy(&d->cond);
+    pthread_mutex_destroy(&d->lock);
+    delete d;
+}
+
+void Barrier::wait()
+{
+    pthread_mutex_lock(&d->lock);
+    const unsigned int gen = generation;
+    if( ++waiting == count )
+    {
+        waiting = 0;
+        generation++;
+        pthread_cond_broadcast(&d->cond);
+    }else
+        while( gen == generation )
+            pthread_cond_wait(&d->cond, &d->lock);
+    pthread_mutex_unlock(&d->lock);
+}
+
+#endif
+
+Thread::Thread():d(new Imp())
+{
+    d->function = 0;
+    d->arg = 0;
+#if defined(_WIN32) && !defined(__GNUC__)
+    d->handle = 0;
+#else
+    d->running = false;
+#endif
+}
+
+Thread::~Thread()
+{
+    join();
+    delete d;
+}
+
+bool Thread::parseCpuList(const std::string& str, std::vector<int>& cpus)
+{
+    cpus.clear();
+    const char* p = str.c_str();
+    while( *p )
+    {
+        char* end;
+        const long from = strtol(p, &end, 10);
+        if( end == p || from < 0 )
+            return false;
+        long to = from;
+        p = end;
+        if( *p == '-' )
+        {
+            p++;
+            to = strtol(p, &end, 10);
+            if( end == p || to < from )
+                return false;
+            p = end;
+        }
+        for( long i = from; i <= to; i++ )
+            cpus.push_back(i);
+        if( *p == ',' )
+            p++;
+        else if( *p != 0 )
+            return false;
+    }
+    return !cpus.empty();
+}
+
+ThreadPool::ThreadPool(int workers):queue(16),head(0),queued(0),pending(0),stopping(false)
+{
+    for( int i = 0; i < workers; i++ )
+    {
+        Thread* t = new Thread();
+        if( !t->start(workerMain, this) )
+        {
+            delete t;
+            break;
+        }
+        threads.push_back(t);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    lock.lock();
+    stopping = true;
+    workAvailable.broadcast();
+    lock.unlock();
+    for( int i = 0; i < (int)threads.size(); i++ )
+        delete threads[i]; // joins
+}
+
+void ThreadPool::run(Task task, void* arg)
+{
+    lock.lock();
+    if( queued == (int)queue.size() )
+    {
+        // grow the ring buffer, keeping the order
+        std::vector<Job> q(queue.size() * 2);
+        for( int i = 0; i < queued; i++ )
+            q[i] = queue[(head + i) % queue.size()];
+        queue.swap(q);
+        head = 0;
+    }
+    Job& j = queue[(head + queued) % queue.size()];
+    j.task = task;
+    j.arg = arg;
+    queued++;
+    pending++;
+    workAvailable.signal();
+    lock.unlock();
+}
+
+bool ThreadPool::execute()
+{
+    if( queued == 0 )
+        return false;
+    const Job j = queue[head];
+    head = (head + 1) % queue.size();
+    queued--;
+    lock.unlock();
+    j.task(j.arg);
+    lock.lock();
+    if( --pending == 0 )
+        allDone.broadcast();
+    return true;
+}
+
+void ThreadPool::wait()
+{
+    lock.lock();
+    while( pending > 0 )
+    {
+        if( !execute() )
+            allDone.wait(lock);
+    }
+    lock.unlock();
+}
+
+void ThreadPool::workerMain(void* arg)
+{
+    ThreadPool* p = (ThreadPool*)arg;
+    p->lock.lock();
+    while( true )
+    {
+        if( p->execute() )
+            continue;
+        if( p->stopping )
+            break;
+        p->workAvailable.wait(p->lock);
+    }
+    p->lock.unlock();
+}
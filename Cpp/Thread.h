@@ -0,0 +1,132 @@
+#ifndef _THREAD_H
+#define _THREAD_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+
+#include "som/Interfaces.h" // THREAD_LOCAL
+
+// Minimal thread and barrier wrappers (pthreads, or Win32 with MSVC) as used by
+// the throughput mode of Run; global state shared by benchmarks must be THREAD_LOCAL.
+class Thread {
+public:
+    typedef void (*Function)(void* arg);
+
+    Thread();
+    ~Thread();
+    bool start(Function, void* arg);
+    void join();
+
+    // binds the calling thread to the given logical CPU; returns false if not supported
+    static bool pinCurrent(int cpu);
+    static int cpuCount();
+    // parses a list like "0,2,4-7"; returns false on syntax error
+    static bool parseCpuList(const std::string&, std::vector<int>& cpus);
+
+    struct Imp;
+private:
+    Thread(const Thread&);
+    Thread& operator=(const Thread&);
+    Imp* d;
+};
+
+class Mutex {
+public:
+    Mutex();
+    ~Mutex();
+    void lock();
+    void unlock();
+private:
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+    friend class Condition;
+    struct Imp;
+    Imp* d;
+};
+
+class Condition {
+public:
+    Condition();
+    ~Condition();
+    // the mutex must be locked by the caller
+    void wait(Mutex&);
+    void signal();
+    void broadcast();
+private:
+    Condition(const Condition&);
+    Condition& operator=(const Condition&);
+    struct Imp;
+    Imp* d;
+};
+
+// Blocks each caller of wait() until count threads have called it; reusable.
+class Barrier {
+public:
+    Barrier(int count);
+    ~Barrier();
+    void wait();
+private:
+    Barrier(const Barrier&);
+    Barrier& operator=(const Barrier&);
+    struct Imp;
+    Imp* d;
+    int count;
+    int waiting;
+    unsigned int generation;
+};
+
+// A fixed number of worker threads which execute queued tasks in FIFO order. Tasks may
+// queue further tasks; wait() returns when all of them are done, and the waiting thread
+// executes queued tasks in the meantime, so a pool with zero workers runs everything
+// in wait().
+class ThreadPool {
+public:
+    typedef void (*Task)(void* arg);
+
+    ThreadPool(int workers);
+    ~ThreadPool();
+    void run(Task, void* arg);
+    void wait();
+    int workers() const { return threads.size(); }
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+    struct Job {
+        Task task;
+        void* arg;
+    };
+    static void workerMain(void* arg);
+    bool execute(); // called with the lock held; false if there was nothing queued
+    std::vector<Thread*> threads;
+    std::vector<Job> queue; // ring buffer
+    int head;
+    int queued;
+    int pending; // queued or executing
+    bool stopping;
+    Mutex lock;
+    Condition workAvailable;
+    Condition allDone;
+};
+
+#endif // _THREAD_H
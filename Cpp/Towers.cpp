@@ -22,6 +22,7 @@
  */
 
 #include "Towers.h"
+#include "Registry.h"
 
 void Towers::pushDisk(Towers::TowersDisk *disk, int pile)
 {
@@ -83,3 +84,5 @@ int Towers::benchmark()
             delete piles[i];
     return movesDone;
 }
+
+static Registration<Towers> registration("Towers", Registry::Micro, 600, 1);
@@ -21,18 +21,237 @@
 
 #include <iostream>
 #include "Run.h"
+#include "Clock.h"
+#include "Registry.h"
+#include "Report.h"
+#include "PerfCounters.h"
+#include "Thread.h"
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include "Allocator.h"
+#include "Results.h"
 #include "som/Random.h"
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
-static void run( const std::string& what, int numIterations, int innerIterations )
+struct Options {
+    std::string patterns;
+    int numIterations;      // 0 means the registered default
+    int innerIterations;    // 0 means the registered default
+    int warmup;
+    int repeat;
+    bool list;
+    bool counters;
+    std::vector<int> threads; // thread counts of the throughput mode, empty if off
+    std::vector<int> cpus;
+    std::vector<std::string> allocators; // empty means the system allocator only
+    std::string clock;
+    std::string json;
+    std::string csv;
+    std::string csvSamples;
+    std::string results;
+    std::string baseline;
+    double alpha;
+    bool save;
+    Options():numIterations(0),innerIterations(0),warmup(Run::AUTO_WARMUP),repeat(1),list(false),counters(false),
+        results("awfy-results.tsv"),alpha(0.01),save(false) {}
+};
+
+static void usage(const char* app)
 {
-    Run r(what);
-    r.setNumIterations(numIterations);
-    r.setInnerIterations(innerIterations);
+    std::cout << "Usage: " << app << " [options] [patterns]" << std::endl <<
+        "Runs the benchmarks selected by the comma separated patterns (default all); a pattern" << std::endl <<
+        "is a glob with '*' and '?' or a /regex/, a '-' prefix excludes the matching benchmarks," << std::endl <<
+        "e.g. 'Json,CD' or '*,-Havlak'." << std::endl <<
+        "  -b, --bench PATTERNS    same as the patterns argument" << std::endl <<
+        "  -l, --list              list the benchmarks with their default iterations and exit" << std::endl <<
+        "  -n, --iterations N      outer iterations, i.e. number of samples" << std::endl <<
+        "  -i, --inner N           inner iterations per sample" << std::endl <<
+        "      --once              one outer iteration per benchmark (smoke run)" << std::endl <<
+        "  -w, --warmup auto|N     detect the steady state or discard the first N samples" << std::endl <<
+        "  -r, --repeat N          run each benchmark N times" << std::endl <<
+        "      --clock NAME        timer backend: " << Clock::available() << std::endl <<
+        "  -t, --threads N|LIST    throughput mode with 1..N or the listed numbers of threads" << std::endl <<
+        "      --cpus LIST         pin the threads round robin to these CPUs, e.g. 0,2,4-7" << std::endl <<
+        "      --alloc LIST        run with each of these allocators and compare: " << Allocator::available() << " or all" << std::endl <<
+        "      --counters          count cycles, instructions, cache, branch and TLB misses per sample" << std::endl <<
+        "      --json FILE         write summaries and samples as JSON ('-' for stdout)" << std::endl <<
+        "      --csv FILE          write one summary line per run as CSV" << std::endl <<
+        "      --csv-samples FILE  write one line per sample as CSV" << std::endl <<
+        "      --save              append the samples to the results file" << std::endl <<
+        "      --results FILE      results file (default awfy-results.tsv)" << std::endl <<
+        "      --baseline SPEC     compare with a saved session: last, a time stamp or a revision;" << std::endl <<
+        "                          the exit code is 3 if there are significant regressions" << std::endl <<
+        "      --alpha X           significance level of the comparison (default 0.01)" << std::endl <<
+        "  -h, --help              show this text" << std::endl;
+}
+
+static bool toInt(const std::string& str, int& res, int min)
+{
+    char* end = 0;
+    const long l = strtol(str.c_str(), &end, 10);
+    if( str.empty() || *end != 0 || l < min )
+        return false;
+    res = l;
+    return true;
+}
+
+// returns 0 if ok, 1 if the arguments are invalid and -1 if there is nothing to run
+static int parseArgs(int argc, char *argv[], Options& o)
+{
+    const char* clock = getenv("AWFY_CLOCK");
+    if( clock )
+        o.clock = clock;
+    for( int i = 1; i < argc; i++ )
+    {
+        std::string arg = argv[i];
+        std::string value;
+        bool hasValue = false;
+        if( arg.size() > 2 && arg[0] == '-' && arg[1] == '-' && arg.find('=') != std::string::npos )
+        {
+            value = arg.substr(arg.find('=') + 1);
+            arg = arg.substr(0, arg.find('='));
+            hasValue = true;
+        }
+        const bool needsValue = arg == "-n" || arg == "--iterations" || arg == "-i" || arg == "--inner" ||
+                arg == "-w" || arg == "--warmup" || arg == "-r" || arg == "--repeat" || arg == "--clock" ||
+                arg == "-t" || arg == "--threads" || arg == "--cpus" || arg == "--alloc" ||
+                arg == "--json" || arg == "--csv" || arg == "--csv-samples" || arg == "-b" || arg == "--bench" ||
+                arg == "--results" || arg == "--baseline" || arg == "--alpha";
+        if( needsValue && !hasValue )
+        {
+            if( i + 1 >= argc )
+            {
+                std::cerr << "missing value for " << arg << std::endl;
+                return 1;
+            }
+            value = argv[++i];
+        }else if( !needsValue && hasValue )
+        {
+            std::cerr << "option " << arg << " takes no value" << std::endl;
+            return 1;
+        }
+
+        bool ok = true;
+        if( arg == "-h" || arg == "--help" )
+        {
+            usage(argv[0]);
+            return -1;
+        }else if( arg == "-l" || arg == "--list" )
+            o.list = true;
+        else if( arg == "-n" || arg == "--iterations" )
+            ok = toInt(value, o.numIterations, 1);
+        else if( arg == "-i" || arg == "--inner" )
+            ok = toInt(value, o.innerIterations, 1);
+        else if( arg == "--once" )
+            o.numIterations = 1;
+        else if( arg == "-w" || arg == "--warmup" )
+        {
+            if( value == "auto" )
+                o.warmup = Run::AUTO_WARMUP;
+            else
+                ok = toInt(value, o.warmup, 0);
+        }else if( arg == "-r" || arg == "--repeat" )
+            ok = toInt(value, o.repeat, 1);
+        else if( arg == "-t" || arg == "--threads" )
+        {
+            int n;
+            if( value.find_first_of(",-") == std::string::npos && toInt(value, n, 1) )
+            {
+                o.threads.clear();
+                for( int t = 1; t <= n; t++ )
+                    o.threads.push_back(t);
+            }else
+            {
+                ok = Thread::parseCpuList(value, o.threads);
+                for( int t = 0; t < (int)o.threads.size(); t++ )
+                    ok = ok && o.threads[t] > 0;
+            }
+        }else if( arg == "--cpus" )
+            ok = Thread::parseCpuList(value, o.cpus);
+        else if( arg == "--alloc" )
+        {
+            o.allocators.clear();
+            if( value == "all" )
+                value = Allocator::available();
+            std::string::size_type pos = 0;
+            while( ok && pos != std::string::npos )
+            {
+                const std::string::size_type comma = value.find(',', pos);
+                std::string name = value.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+                pos = comma == std::string::npos ? comma : comma + 1;
+                while( !name.empty() && name[0] == ' ' )
+                    name.erase(0, 1);
+                Allocator* a = Allocator::create(name);
+                ok = a != 0;
+                delete a;
+                o.allocators.push_back(name);
+            }
+        }else if( arg == "--counters" )
+            o.counters = true;
+        else if( arg == "--clock" )
+            o.clock = value;
+        else if( arg == "--json" )
+            o.json = value;
+        else if( arg == "--csv" )
+            o.csv = value;
+        else if( arg == "--csv-samples" )
+            o.csvSamples = value;
+        else if( arg == "--save" )
+            o.save = true;
+        else if( arg == "--results" )
+            o.results = value;
+        else if( arg == "--baseline" )
+            o.baseline = value;
+        else if( arg == "--alpha" )
+        {
+            char* end = 0;
+            o.alpha = strtod(value.c_str(), &end);
+            ok = !value.empty() && *end == 0 && o.alpha > 0 && o.alpha < 1;
+        }else if( arg == "-b" || arg == "--bench" || arg[0] != '-' )
+        {
+            if( arg[0] != '-' )
+                value = arg;
+            if( !o.patterns.empty() )
+                o.patterns += ",";
+            o.patterns += value;
+        }else
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+        if( !ok )
+        {
+            std::cerr << "invalid value for " << arg << ": " << value << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static bool run( const Registry::Info* info, const Options& o, int repeat, Report& report, Allocator* allocator,
+                 int threads = 0 )
+{
+    Run r(info->name, allocator);
+    r.setNumIterations(o.numIterations ? o.numIterations : info->numIterations);
+    r.setInnerIterations(o.innerIterations ? o.innerIterations : info->innerIterations);
+    r.setWarmup(o.warmup);
+    std::string error;
+    if( o.counters && threads == 0 && !r.enableCounters(error) )
+        std::cerr << "WARNING: performance counters not available: " << error << std::endl;
     try
     {
-        r.runBenchmark();
-        r.printTotal();
+        if( threads > 0 )
+            r.runThroughput(threads, o.cpus);
+        else
+        {
+            r.runBenchmark();
+            r.printTotal();
+        }
+        report.add(r, repeat);
+        return !r.hasFailed();
     }catch( const char* msg )
     {
         std::cerr << msg << std::endl;
@@ -46,48 +265,261 @@ static void run( const std::string& what, int numIterations, int innerIterations
     {
         std::cerr << "unexpected exception" << std::endl;
     }
+    return false;
 }
 
-static void runAll()
+// throughput of the runs of info in the throughput mode relative to the one with the fewest threads
+static void printScaling(const Registry::Info* info, const Report& report, int repeat, const char* allocator)
 {
-    run("DeltaBlue", 12000, 1 );
-    run("Richards", 100, 1);
-    run("Json", 100, 1);
-    run("Havlak", 10, 1 );
-    run("CD", 250, 2);
-    run("Bounce", 1500, 1);
-    run("List", 1500, 1);
-    run("Mandelbrot", 500, 1);
-    run("NBody", 250000, 1);
-    run("Permute", 1000, 1);
-    run("Queens", 1000, 1);
-    run("Sieve", 3000, 1);
-    run("Storage", 1000, 1);
-    run("Towers", 600, 1);
+    const std::vector<Report::Record>& records = report.getRecords();
+    const Report::Record* base = 0;
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        const Report::Record& r = records[i];
+        if( r.name == info->name && r.repeat == repeat && r.allocator == allocator && r.threads > 0 &&
+                !r.failed && (base == 0 || r.threads < base->threads) )
+            base = &r;
+    }
+    if( base == 0 || base->throughput <= 0 )
+        return;
+    const std::ios::fmtflags flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(3);
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        const Report::Record& r = records[i];
+        if( r.name != info->name || r.repeat != repeat || r.allocator != allocator || r.threads == 0 || r.failed )
+            continue;
+        const double speedup = r.throughput / base->throughput;
+        std::cout << info->name << ": scaling threads=" << r.threads << " throughput: " << r.throughput <<
+                     "/s speedup: " << speedup << " efficiency: " << speedup * base->threads / r.threads << std::endl;
+    }
+    std::cout << std::endl;
+    std::cout.flags(flags);
+}
+
+// median of the sample medians of the repeats, per benchmark and allocator
+static void printAllocatorComparison(const std::vector<const Registry::Info*>& infos, const Report& report,
+                                     const std::vector<Allocator*>& allocators)
+{
+    const std::vector<Report::Record>& records = report.getRecords();
+    std::vector<int> threads;
+    for( int i = 0; i < (int)records.size(); i++ )
+    {
+        if( std::find(threads.begin(), threads.end(), records[i].threads) == threads.end() )
+            threads.push_back(records[i].threads);
+    }
+    std::sort(threads.begin(), threads.end());
+
+    const std::ios::fmtflags flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Allocator comparison (median us per sample, relative to " << allocators[0]->name() << ")" << std::endl;
+    std::cout << std::left << std::setw(16) << "benchmark";
+    for( int a = 0; a < (int)allocators.size(); a++ )
+        std::cout << std::setw(24) << allocators[a]->name();
+    std::cout << std::endl;
+    for( int i = 0; i < (int)infos.size(); i++ )
+    {
+        for( int t = 0; t < (int)threads.size(); t++ )
+        {
+            std::string label = infos[i]->name;
+            if( threads[t] > 0 )
+            {
+                std::ostringstream ss;
+                ss << label << "/" << threads[t] << "t";
+                label = ss.str();
+            }
+            std::cout << std::setw(16) << label;
+            double base = 0;
+            for( int a = 0; a < (int)allocators.size(); a++ )
+            {
+                std::vector<double> medians;
+                for( int j = 0; j < (int)records.size(); j++ )
+                {
+                    const Report::Record& r = records[j];
+                    if( r.name == infos[i]->name && r.threads == threads[t] &&
+                            r.allocator == allocators[a]->name() && !r.failed )
+                        medians.push_back(r.summary.median);
+                }
+                std::ostringstream cell;
+                cell << std::fixed << std::setprecision(3);
+                if( medians.empty() )
+                    cell << "-";
+                else
+                {
+                    const double m = Statistics::median(medians);
+                    if( a == 0 )
+                        base = m;
+                    cell << m;
+                    if( a != 0 && base > 0 )
+                        cell << " (" << std::setprecision(2) << m / base << ")";
+                }
+                std::cout << std::setw(24) << cell.str();
+            }
+            std::cout << std::endl;
+        }
+    }
+    std::cout << std::endl;
+    std::cout.flags(flags);
 }
 
-static void runOnce()
+static void list(const std::vector<const Registry::Info*>& infos)
 {
-    run("DeltaBlue", 1, 1 );
-    run("Richards", 1, 1);
-    run("Json", 1, 1);
-    run("Havlak", 1, 1 );
-    run("CD", 1, 2);
-    run("Bounce", 1, 1);
-    run("List", 1, 1);
-    run("Mandelbrot", 1, 1);
-    run("NBody", 1, 1);
-    run("Permute", 1, 1);
-    run("Queens", 1, 1);
-    run("Sieve", 1, 1);
-    run("Storage", 1, 1);
-    run("Towers", 1, 1);
+    for( int i = 0; i < (int)infos.size(); i++ )
+    {
+        const Registry::Info* info = infos[i];
+        std::cout << info->name << " " << (info->kind == Registry::Macro ? "macro" : "micro") <<
+                     " iterations=" << info->numIterations << " inner=" << info->innerIterations;
+        if( info->verifiedInnerIterations )
+        {
+            std::cout << " verified inner=";
+            for( const int* n = info->verifiedInnerIterations; *n != 0; n++ )
+                std::cout << (n == info->verifiedInnerIterations ? "" : ",") << *n;
+        }
+        std::cout << std::endl;
+    }
 }
 
 int main(int argc, char *argv[])
 {
-    runAll();
-    //runOnce();
+    Options o;
+    const int res = parseArgs(argc, argv, o);
+    if( res != 0 )
+        return res < 0 ? 0 : 1;
 
-    return 0;
+    std::vector<const Registry::Info*> infos;
+    std::string error;
+    if( !Registry::select(o.patterns, infos, error) )
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if( o.list )
+    {
+        list(infos);
+        return 0;
+    }
+    if( infos.empty() )
+    {
+        std::cerr << "no benchmark matches " << o.patterns << std::endl;
+        return 1;
+    }
+
+    if( !o.clock.empty() && !Clock::select(o.clock) )
+    {
+        std::cerr << "unknown or unsupported clock " << o.clock << ", available: " << Clock::available() << std::endl;
+        return 1;
+    }
+    std::vector<Results::Entry> baseline;
+    if( !o.baseline.empty() )
+    {
+        std::vector<Results::Entry> entries;
+        if( !Results::load(o.results, entries, error) )
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        baseline = Results::select(entries, o.baseline);
+        if( baseline.empty() )
+        {
+            std::cerr << "no session " << o.baseline << " in " << o.results << std::endl;
+            return 1;
+        }
+    }
+    Clock::printInfo(std::cout);
+    if( o.counters && !o.threads.empty() )
+    {
+        std::cerr << "WARNING: performance counters are not collected in the throughput mode" << std::endl;
+        o.counters = false;
+    }
+    if( o.counters )
+    {
+        PerfCounters probe;
+        if( !probe.open(error) )
+        {
+            std::cerr << "WARNING: performance counters not available: " << error << std::endl;
+            o.counters = false;
+        }
+    }
+    std::cout << std::endl;
+
+    for( int i = 0; i < (int)o.cpus.size(); i++ )
+    {
+        if( o.cpus[i] >= Thread::cpuCount() )
+        {
+            std::cerr << "CPU " << o.cpus[i] << " not available, there are " << Thread::cpuCount() << std::endl;
+            return 1;
+        }
+    }
+
+    // the allocators live until the end, since blocks refer to the allocator which owns them
+    std::vector<Allocator*> allocators;
+    for( int i = 0; i < (int)o.allocators.size(); i++ )
+        allocators.push_back(Allocator::create(o.allocators[i]));
+    if( allocators.empty() )
+        allocators.push_back(Allocator::current());
+
+    Report report;
+    bool ok = true;
+    for( int i = 0; i < (int)infos.size(); i++ )
+    {
+        const int inner = o.innerIterations ? o.innerIterations : infos[i]->innerIterations;
+        if( !infos[i]->canVerify(inner) )
+            std::cerr << "WARNING: " << infos[i]->name << " has no verification result for " <<
+                         inner << " inner iterations" << std::endl;
+        for( int a = 0; a < (int)allocators.size(); a++ )
+        {
+            for( int r = 0; r < o.repeat; r++ )
+            {
+                if( o.threads.empty() )
+                {
+                    if( !run(infos[i], o, r, report, allocators[a]) )
+                        ok = false;
+                    continue;
+                }
+                for( int t = 0; t < (int)o.threads.size(); t++ )
+                {
+                    if( !run(infos[i], o, r, report, allocators[a], o.threads[t]) )
+                        ok = false;
+                }
+                printScaling(infos[i], report, r, allocators[a]->name());
+            }
+        }
+    }
+    if( allocators.size() > 1 )
+        printAllocatorComparison(infos, report, allocators);
+
+    int regressions = 0;
+    if( !baseline.empty() )
+    {
+        std::cout << std::endl;
+        regressions = Results::compare(report, baseline, o.alpha, std::cout);
+    }
+    if( o.save && !Results::append(o.results, report, error) )
+    {
+        std::cerr << error << std::endl;
+        ok = false;
+    }
+
+    if( !o.json.empty() && !report.write(o.json, &Report::writeJson) )
+    {
+        std::cerr << "cannot write " << o.json << std::endl;
+        ok = false;
+    }
+    if( !o.csv.empty() && !report.write(o.csv, &Report::writeCsv) )
+    {
+        std::cerr << "cannot write " << o.csv << std::endl;
+        ok = false;
+    }
+    if( !o.csvSamples.empty() && !report.write(o.csvSamples, &Report::writeSamplesCsv) )
+    {
+        std::cerr << "cannot write " << o.csvSamples << std::endl;
+        ok = false;
+    }
+
+    for( int i = 0; i < (int)o.allocators.size(); i++ )
+        delete allocators[i];
+
+    if( !ok )
+        return 2;
+    return regressions ? 3 : 0;
 }
@@ -87,6 +87,7 @@ protected:
 
     template<class KK, class VV>
     struct Entry {
+        ALLOCATED_BY_CURRENT
 
         int refCount;
         int hash;
@@ -120,18 +121,18 @@ private:
 public:
 
     Dictionary(int len):sz(0) {
-        buckets = new EntryRef<K,V>[len];
+        buckets = Allocator::newArray<EntryRef<K,V> >(len);
         length = len;
     }
 
     Dictionary():sz(0),length(0) {
         length = INITIAL_CAPACITY;
-        buckets = new EntryRef<K,V>[length];
+        buckets = Allocator::newArray<EntryRef<K,V> >(length);
     }
 
     ~Dictionary()
     {
-        delete[] buckets;
+        Allocator::deleteArray(buckets, length);
     }
 
     int hash(const K& key) {
@@ -231,10 +232,10 @@ public:
         const int oldLen = length;
 
         length *= 2;
-        EntryRef<K,V>* newStorage = new EntryRef<K,V>[length];
+        EntryRef<K,V>* newStorage = Allocator::newArray<EntryRef<K,V> >(length);
         buckets = newStorage;
         transferEntries(oldStorage,oldLen);
-        delete[] oldStorage;
+        Allocator::deleteArray(oldStorage, oldLen);
     }
 
 
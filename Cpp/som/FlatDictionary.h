@@ -0,0 +1,304 @@
+#ifndef SOM_FLATDICTIONARY_H
+#define SOM_FLATDICTIONARY_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <som/Vector.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOM_SSE2
+#endif
+
+// Benchmark variant switch: if defined, DeltaBlue and Havlak use the chained Dictionary
+// instead of FlatDictionary
+// #define SOM_CHAINED_DICTIONARY
+
+namespace som {
+
+// Control bytes of FlatDictionary: EMPTY or the low seven bits of the hash of the key
+// in the slot. A group are the 16 bytes from any position, which are compared at once.
+struct FlatGroup {
+    enum { SIZE = 16, EMPTY = 0x80 };
+
+    // bit i is set if ctrl[i] == b
+    static unsigned int match(const unsigned char* ctrl, unsigned char b) {
+#ifdef SOM_SSE2
+        const __m128i g = _mm_loadu_si128((const __m128i*)ctrl);
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)b)));
+#else
+        unsigned int m = 0;
+        for (int i = 0; i < SIZE; i++) {
+            m |= (unsigned int)(ctrl[i] == b) << i;
+        }
+        return m;
+#endif
+    }
+
+    static unsigned int matchEmpty(const unsigned char* ctrl) {
+#ifdef SOM_SSE2
+        // only EMPTY has the high bit set
+        return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#else
+        return match(ctrl, EMPTY);
+#endif
+    }
+};
+
+// Open addressing hash table with the same interface as Dictionary. Keys and values are
+// stored inline in a slot array and found by linear probing, where each step compares
+// the control bytes of a whole group with the seven hash bits of the key (using SSE2 if
+// available). Removal shifts the following entries of the probe sequence back instead
+// of leaving a tombstone, so lookups never have to skip deleted slots and growing is the
+// only reason to rehash.
+template<class K, class V, class H>
+class FlatDictionary {
+protected:
+    enum { INITIAL_CAPACITY = 16 }; // at least FlatGroup::SIZE
+
+    struct Slot {
+        K key;
+        V value;
+        Slot(const K& k, const V& v):key(k),value(v) {}
+    };
+
+private:
+    unsigned char* ctrl; // capacity + FlatGroup::SIZE - 1 bytes; the first ones are mirrored at the end
+    Slot* slots;
+    int capacity;        // power of two
+    int sz;
+
+    FlatDictionary(const FlatDictionary&);
+    FlatDictionary& operator=(const FlatDictionary&);
+
+    unsigned int fullHash(const K& key) {
+        H hash;
+        return mixHash(hash(key));
+    }
+
+    int home(unsigned int h) const {
+        return (h >> 7) & (capacity - 1);
+    }
+
+    static unsigned char tag(unsigned int h) {
+        return h & 0x7f;
+    }
+
+    void setCtrl(int i, unsigned char b) {
+        ctrl[i] = b;
+        if (i < FlatGroup::SIZE - 1) {
+            ctrl[capacity + i] = b;
+        }
+    }
+
+    void allocate(int cap) {
+        capacity = cap;
+        ctrl = (unsigned char*)Allocator::allocate(cap + FlatGroup::SIZE - 1);
+        memset(ctrl, FlatGroup::EMPTY, cap + FlatGroup::SIZE - 1);
+        slots = (Slot*)Allocator::allocate(cap * sizeof(Slot));
+    }
+
+    // returns the slot of key, or -1 and the first free slot of its probe sequence
+    int find(const K& key, unsigned int h, int& free) const {
+        const int mask = capacity - 1;
+        int pos = home(h);
+        while (true) {
+            unsigned int m = FlatGroup::match(ctrl + pos, tag(h));
+            while (m) {
+                const int i = (pos + lowestBit(m)) & mask;
+                if (slots[i].key == key) {
+                    return i;
+                }
+                m &= m - 1;
+            }
+            const unsigned int e = FlatGroup::matchEmpty(ctrl + pos);
+            if (e) {
+                free = (pos + lowestBit(e)) & mask;
+                return -1;
+            }
+            pos = (pos + FlatGroup::SIZE) & mask;
+        }
+    }
+
+    int findFree(unsigned int h) const {
+        const int mask = capacity - 1;
+        int pos = home(h);
+        while (true) {
+            const unsigned int e = FlatGroup::matchEmpty(ctrl + pos);
+            if (e) {
+                return (pos + lowestBit(e)) & mask;
+            }
+            pos = (pos + FlatGroup::SIZE) & mask;
+        }
+    }
+
+    void destroy() {
+        for (int i = 0; i < capacity; i++) {
+            if (ctrl[i] != FlatGroup::EMPTY) {
+                slots[i].~Slot();
+            }
+        }
+    }
+
+public:
+    FlatDictionary(int len):sz(0) {
+        int cap = INITIAL_CAPACITY;
+        while (cap < len) {
+            cap *= 2;
+        }
+        allocate(cap);
+    }
+
+    FlatDictionary():sz(0) {
+        allocate(INITIAL_CAPACITY);
+    }
+
+    ~FlatDictionary() {
+        destroy();
+        Allocator::deallocate(ctrl);
+        Allocator::deallocate(slots);
+    }
+
+    int hash(const K& key) {
+        return fullHash(key);
+    }
+
+    int size() {
+        return sz;
+    }
+
+    bool isEmpty() {
+        return sz == 0;
+    }
+
+    V* at(const K& key) {
+        int free;
+        const int i = find(key, fullHash(key), free);
+        return i < 0 ? 0 : &slots[i].value;
+    }
+
+    bool containsKey(const K& key) {
+        int free;
+        return find(key, fullHash(key), free) >= 0;
+    }
+
+    void atPut(const K& key, const V& value) {
+        const unsigned int h = fullHash(key);
+        int free;
+        const int i = find(key, h, free);
+        if (i >= 0) {
+            slots[i].value = value;
+            return;
+        }
+        if ((sz + 1) * 4 > capacity * 3) {
+            resize();
+            free = findFree(h);
+        }
+        new(slots + free) Slot(key, value);
+        setCtrl(free, tag(h));
+        sz++;
+    }
+
+    bool remove(const K& key) {
+        int free;
+        int i = find(key, fullHash(key), free);
+        if (i < 0) {
+            return false;
+        }
+        slots[i].~Slot();
+        // move the following entries of the run back if the freed slot is still
+        // on their probe sequence
+        const int mask = capacity - 1;
+        int j = i;
+        while (true) {
+            j = (j + 1) & mask;
+            if (ctrl[j] == FlatGroup::EMPTY) {
+                break;
+            }
+            const int h = home(fullHash(slots[j].key));
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                new(slots + i) Slot(SOM_MOVE(slots[j]));
+                slots[j].~Slot();
+                setCtrl(i, ctrl[j]);
+                i = j;
+            }
+        }
+        setCtrl(i, FlatGroup::EMPTY);
+        sz--;
+        return true;
+    }
+
+    // keeps the storage
+    void removeAll() {
+        destroy();
+        memset(ctrl, FlatGroup::EMPTY, capacity + FlatGroup::SIZE - 1);
+        sz = 0;
+    }
+
+    void getKeys(Vector<K>& keys) {
+        keys.removeAll();
+        keys.expand(sz);
+        for (int i = 0; i < capacity; ++i) {
+            if (ctrl[i] != FlatGroup::EMPTY) {
+                keys.append(slots[i].key);
+            }
+        }
+    }
+
+    void getValues(Vector<V>& values) {
+        values.removeAll();
+        values.expand(sz);
+        for (int i = 0; i < capacity; ++i) {
+            if (ctrl[i] != FlatGroup::EMPTY) {
+                values.append(slots[i].value);
+            }
+        }
+    }
+
+    void resize() {
+        unsigned char* oldCtrl = ctrl;
+        Slot* oldSlots = slots;
+        const int oldCapacity = capacity;
+        allocate(capacity * 2);
+        for (int i = 0; i < oldCapacity; i++) {
+            if (oldCtrl[i] != FlatGroup::EMPTY) {
+                const int j = findFree(fullHash(oldSlots[i].key));
+                new(slots + j) Slot(SOM_MOVE(oldSlots[i]));
+                oldSlots[i].~Slot();
+                setCtrl(j, oldCtrl[i]);
+            }
+        }
+        Allocator::deallocate(oldCtrl);
+        Allocator::deallocate(oldSlots);
+    }
+};
+
+template<class K, class V, class H>
+class FlatIdentityDictionary : public FlatDictionary<K,V,H> {
+public:
+  FlatIdentityDictionary(int size):FlatDictionary<K,V,H>(size) {}
+
+  FlatIdentityDictionary(){}
+};
+
+}
+
+#endif // SOM_FLATDICTIONARY_H
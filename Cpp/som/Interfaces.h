@@ -24,6 +24,24 @@
  * THE SOFTWARE.
  */
 
+#if __cplusplus >= 201103L
+#include <utility>
+#define SOM_MOVE(x) std::move(x)
+#else
+#define SOM_MOVE(x) (x)
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+// thread local storage of static variables; used by the harness and by som::Random
+#if __cplusplus >= 201103L
+#define THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 namespace som {
 
 template <class E>
@@ -50,6 +68,119 @@ public:
     virtual int compare(const E& lhs, const E& rhs) const = 0;
 };
 
+// The containers also have template overloads of forEach, hasSome and sort which take
+// any function object (called as fn(elem), fn(elem) and fn(lhs, rhs) respectively), so
+// that the compiler can inline the loop body. The benchmarks pass their implementations
+// of the interfaces above through SOM_DISPATCH, which selects one of both styles:
+// inlined() unless SOM_VIRTUAL_DISPATCH is defined. C++98 doesn't permit local classes
+// as template arguments, so there the virtual calls are always used.
+// #define SOM_VIRTUAL_DISPATCH
+
+#if __cplusplus >= 201103L && !defined(SOM_VIRTUAL_DISPATCH)
+#define SOM_DISPATCH(fn) som::inlined(fn)
+#else
+#define SOM_DISPATCH(fn) (fn)
+#endif
+
+template<bool condition, class T = void>
+struct EnableIf {};
+template<class T>
+struct EnableIf<true, T> { typedef T Type; };
+
+template<class D, class B>
+class IsDerived {
+    static char check(const B*);
+    static long check(...);
+public:
+    enum { value = sizeof(check((const D*)0)) == sizeof(char) };
+};
+
+// true if F implements one of the interfaces, i.e. needs the virtual overloads
+template<class F, class E>
+struct IsInterface {
+    enum { value = IsDerived<F, ForEachInterface<E> >::value || IsDerived<F, TestInterface<E> >::value ||
+           IsDerived<F, Comparator<E> >::value };
+};
+
+template<class F, class E, bool isTest = IsDerived<F, TestInterface<E> >::value>
+struct InlinedCall {
+    static bool call(F& f, const E& elem) { f.F::apply(elem); return false; }
+};
+
+template<class F, class E>
+struct InlinedCall<F, E, true> {
+    static bool call(F& f, const E& elem) { return f.F::test(elem); }
+};
+
+// Adapts an implementation of one of the interfaces to a function object; the qualified
+// calls bypass the vtable.
+template<class F>
+class Inlined {
+    F& f;
+public:
+    Inlined(F& fn):f(fn) {}
+    template<class E>
+    bool operator()(const E& elem) const { return InlinedCall<F, E>::call(f, elem); }
+    template<class E>
+    int operator()(const E& lhs, const E& rhs) const { return f.F::compare(lhs, rhs); }
+};
+
+template<class F>
+Inlined<F> inlined(F& fn) { return Inlined<F>(fn); }
+
+template<class F>
+Inlined<const F> inlined(const F& fn) { return Inlined<const F>(fn); }
+
+// Element types whose objects may be moved to another address with memcpy, i.e. without
+// running a copy constructor and destructor; declare further ones with SOM_RELOCATABLE
+// inside namespace som.
+template<class E>
+struct IsRelocatable { enum { value = false }; };
+template<class E>
+struct IsRelocatable<E*> { enum { value = true }; };
+#define SOM_RELOCATABLE(T) template<> struct IsRelocatable<T > { enum { value = true }; };
+SOM_RELOCATABLE(bool)
+SOM_RELOCATABLE(char)
+SOM_RELOCATABLE(signed char)
+SOM_RELOCATABLE(unsigned char)
+SOM_RELOCATABLE(short)
+SOM_RELOCATABLE(unsigned short)
+SOM_RELOCATABLE(int)
+SOM_RELOCATABLE(unsigned int)
+SOM_RELOCATABLE(long)
+SOM_RELOCATABLE(unsigned long)
+SOM_RELOCATABLE(float)
+SOM_RELOCATABLE(double)
+
+// Finalizer of MurmurHash3; spreads the bits of the hashes of the benchmark objects,
+// which are often small consecutive numbers or aligned addresses.
+inline unsigned int mixHash(unsigned int h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// index of the lowest set bit; m must not be 0
+inline int lowestBit(unsigned int m) {
+#if defined(__GNUC__)
+    return __builtin_ctz(m);
+#elif defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return i;
+#else
+    int i = 0;
+    while ((m & 1) == 0) {
+        m >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
 }
 
 #endif // SOM_INTERFACES_H
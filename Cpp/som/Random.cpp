@@ -22,18 +22,14 @@
  */
 
 #include "Random.h"
+#include "Interfaces.h" // THREAD_LOCAL
 using namespace som;
 
-static const int init = 74755;
-static int seed = init;
-
-void Random::reset()
-{
-    seed = init;
-}
-
-int Random::next()
+Random& Random::threadDefault()
 {
-    seed = ((seed * 1309) + 13849) & 65535;
-    return seed;
+    // C++98 thread locals must be POD, hence allocated on first use (and never freed)
+    static THREAD_LOCAL Random* instance = 0;
+    if( instance == 0 )
+        instance = new Random();
+    return *instance;
 }
@@ -26,10 +26,26 @@
 
 namespace som {
 
+// The linear congruential generator of the AWFY suite; the verification results of
+// Bounce and Storage depend on it being started with DEFAULT_SEED.
 class Random {
 public:
-    static void reset();
-    static int next();
+    enum { DEFAULT_SEED = 74755 };
+
+    Random(int seed = DEFAULT_SEED):initial(seed),seed(seed) {}
+
+    void reset() { seed = initial; }
+
+    int next() {
+        seed = ((seed * 1309) + 13849) & 65535;
+        return seed;
+    }
+
+    // used by benchmarks which were not given an instance by the harness; one per thread
+    static Random& threadDefault();
+private:
+    int initial;
+    int seed;
 };
 
 }
@@ -28,22 +28,128 @@
 
 namespace som {
 
+// Hash functions used by Set; only integral and pointer elements are hashed, for all
+// other types Set falls back to the linear scan.
+template<class E>
+struct SetHash {
+    enum { hashed = false };
+    static unsigned int hash(const E&) { return 0; }
+};
+template<class E>
+struct SetHash<E*> {
+    enum { hashed = true };
+    static unsigned int hash(E* p) {
+        const size_t v = (size_t)p;
+        return (unsigned int)(v ^ (v >> 16 >> 16));
+    }
+};
+#define SOM_SET_HASH(T) template<> struct SetHash<T > { \
+    enum { hashed = true }; \
+    static unsigned int hash(T v) { return (unsigned int)v; } };
+SOM_SET_HASH(char)
+SOM_SET_HASH(short)
+SOM_SET_HASH(unsigned short)
+SOM_SET_HASH(int)
+SOM_SET_HASH(unsigned int)
+SOM_SET_HASH(long)
+SOM_SET_HASH(unsigned long)
+
+// The elements are kept in a Vector in insertion order, which is also the order of
+// forEach. Small sets are searched linearly; from LINEAR_LIMIT elements on an open
+// addressing index of positions into the Vector is maintained as well, so that add()
+// doesn't become quadratic for the large sets of Havlak.
 template<class E>
 class Set {
     Vector<E> items;
+    int* index;      // item position + 1, or 0 for a free slot
+    int indexLength; // power of two, 0 while there is no index
+
+    enum { INITIAL_SIZE = 10, LINEAR_LIMIT = 8 };
+
+    struct Equals {
+        const E& obj;
+        Equals(const E& o):obj(o) {}
+        bool operator()(const E& elem) const { return elem == obj; }
+    };
+
+    // returns the slot of obj or the free slot where it belongs
+    int findSlot(const E& obj) const {
+        const int mask = indexLength - 1;
+        int i = mixHash(SetHash<E>::hash(obj)) & mask;
+        while (index[i] != 0 && !(items.at(index[i] - 1) == obj)) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
 
-    enum { INITIAL_SIZE = 10 };
+    // keeps the load factor at most 1/2
+    void buildIndex(int minLength) {
+        Allocator::deallocate(index);
+        indexLength = 16;
+        while (indexLength < minLength * 2) {
+            indexLength *= 2;
+        }
+        index = (int*)Allocator::allocate(indexLength * sizeof(int));
+        memset(index, 0, indexLength * sizeof(int));
+        for (int i = 0; i < items.size(); i++) {
+            index[findSlot(items.at(i))] = i + 1;
+        }
+    }
 
 public:
-    Set()
+    Set():index(0),indexLength(0)
     {
         items.expand(INITIAL_SIZE);
     }
 
-    Set(int size) {
+    Set(int size):index(0),indexLength(0) {
         items.expand(size);
     }
 
+    ~Set() {
+        Allocator::deallocate(index);
+    }
+
+    Set(const Set<E>& rhs):items(rhs.items),index(0),indexLength(0) {
+        if (rhs.index) {
+            buildIndex(items.size());
+        }
+    }
+
+    Set<E>& operator=(const Set<E>& rhs) {
+        if (this == &rhs) {
+            return *this;
+        }
+        items = rhs.items;
+        Allocator::deallocate(index);
+        index = 0;
+        indexLength = 0;
+        if (rhs.index) {
+            buildIndex(items.size());
+        }
+        return *this;
+    }
+
+#if __cplusplus >= 201103L
+    Set(Set<E>&& rhs):items(std::move(rhs.items)),index(rhs.index),indexLength(rhs.indexLength) {
+        rhs.index = 0;
+        rhs.indexLength = 0;
+    }
+
+    Set<E>& operator=(Set<E>&& rhs) {
+        if (this == &rhs) {
+            return *this;
+        }
+        items = std::move(rhs.items);
+        Allocator::deallocate(index);
+        index = rhs.index;
+        indexLength = rhs.indexLength;
+        rhs.index = 0;
+        rhs.indexLength = 0;
+        return *this;
+    }
+#endif
+
     int size() {
         return items.size();
     }
@@ -56,9 +162,43 @@ public:
         return items.hasSome(fn);
     }
 
+    template<class F>
+    typename EnableIf<!IsInterface<F, E>::value>::Type forEach(F fn) {
+        items.forEach(fn);
+    }
+
+    template<class F>
+    typename EnableIf<!IsInterface<F, E>::value, bool>::Type hasSome(F fn) {
+        return items.hasSome(fn);
+    }
+
+    typedef typename Vector<E>::iterator iterator;
+    typedef typename Vector<E>::const_iterator const_iterator;
+
+    iterator begin() { return items.begin(); }
+    iterator end() { return items.end(); }
+    const_iterator begin() const { return items.begin(); }
+    const_iterator end() const { return items.end(); }
+
     void add(const E& obj) {
-        if (!contains(obj)) {
+        if (index == 0) {
+            if (contains(obj)) {
+                return;
+            }
             items.append(obj);
+            if (SetHash<E>::hashed && items.size() >= LINEAR_LIMIT) {
+                buildIndex(items.size());
+            }
+            return;
+        }
+        const int i = findSlot(obj);
+        if (index[i] != 0) {
+            return;
+        }
+        items.append(obj);
+        index[i] = items.size();
+        if (items.size() * 2 > indexLength) {
+            buildIndex(items.size());
         }
     }
 
@@ -79,17 +219,17 @@ public:
     }
 
     bool contains(const E& obj) {
-        struct Iterator : public TestInterface<E>
-        {
-            Iterator(const E& o):obj(o){}
-            const E& obj;
-            bool test(const E& elem) const { return elem == obj; }
-        } it(obj);
-        return hasSome(it);
+        if (index == 0) {
+            return items.hasSome(Equals(obj));
+        }
+        return index[findSlot(obj)] != 0;
     }
 
     void removeAll() {
         items.removeAll();
+        Allocator::deallocate(index);
+        index = 0;
+        indexLength = 0;
     }
 };
 
@@ -100,6 +240,11 @@ public:
   IdentitySet(int size):Set<E>(size) {}
 
 };
+
+template<class E>
+struct IsRelocatable<Set<E> > { enum { value = true }; };
+template<class E>
+struct IsRelocatable<IdentitySet<E> > { enum { value = true }; };
 }
 
 #endif // SOM_SET_H
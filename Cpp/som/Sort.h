@@ -0,0 +1,267 @@
+#ifndef SOM_SORT_H
+#define SOM_SORT_H
+
+/* Copyright (c) 2026 Rochus Keller <me@rochus-keller.ch>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <som/Interfaces.h>
+#include <string.h>
+
+class ThreadPool;
+
+namespace som {
+
+template<class E, bool relocatable = IsRelocatable<E>::value>
+struct Swapper {
+    static void swap(E& a, E& b) {
+        E t(SOM_MOVE(a));
+        a = SOM_MOVE(b);
+        b = SOM_MOVE(t);
+    }
+};
+
+template<class E>
+struct Swapper<E, true> {
+    static void swap(E& a, E& b) {
+        char t[sizeof(E)];
+        memcpy(t, (const void*)&a, sizeof(E));
+        memmove((void*)&a, (const void*)&b, sizeof(E));
+        memcpy((void*)&b, t, sizeof(E));
+    }
+};
+
+// Introsort: quicksort with a median of three (or of nine for larger ranges) pivot,
+// insertion sort for short ranges and heapsort if the recursion gets too deep. c is
+// called like Comparator::compare. For relocatable element types the partitioning
+// is branchless, i.e. each element is swapped unconditionally and the boundary is
+// advanced by the result of the comparison. A range whose pivot equals the pivot of
+// the enclosing range (which precedes it) is partitioned into the elements equal to
+// it and the greater ones, so many duplicates don't degrade the performance.
+template<class E, class F>
+class Sorter {
+public:
+    enum { INSERTION_LIMIT = 24, NINTHER_LIMIT = 128, PARALLEL_LIMIT = 4096 };
+
+    static void sort(E* a, int n, F& c) {
+        loop(a, n, c, depthLimit(n), true);
+    }
+
+    // ranges larger than PARALLEL_LIMIT are split into tasks on the pool; P is ThreadPool,
+    // a parameter so that only the callers of this overload have to include Thread.h
+    template<class P>
+    static void sort(E* a, int n, F& c, P& pool) {
+        parallelLoop(a, n, c, depthLimit(n), true, pool);
+        pool.wait();
+    }
+
+    static void swap(E& a, E& b) {
+        Swapper<E>::swap(a, b);
+    }
+
+private:
+    struct Less {
+        F& c;
+        const E& pivot;
+        Less(F& cmp, const E& p):c(cmp),pivot(p) {}
+        bool operator()(const E& e) const { return c(e, pivot) < 0; }
+    };
+
+    struct NotGreater {
+        F& c;
+        const E& pivot;
+        NotGreater(F& cmp, const E& p):c(cmp),pivot(p) {}
+        bool operator()(const E& e) const { return c(pivot, e) >= 0; }
+    };
+
+    template<class P>
+    struct Task {
+        E* a;
+        int n;
+        F* c;
+        int depth;
+        bool leftmost;
+        P* pool;
+        static void run(void* arg) {
+            Task* t = (Task*)arg;
+            parallelLoop(t->a, t->n, *t->c, t->depth, t->leftmost, *t->pool);
+            delete t;
+        }
+    };
+
+    static int depthLimit(int n) {
+        int d = 0;
+        while (n > 1) {
+            d += 2;
+            n >>= 1;
+        }
+        return d;
+    }
+
+    static void sort3(E* a, E* b, E* d, F& c) {
+        if (c(*b, *a) < 0)
+            swap(*a, *b);
+        if (c(*d, *b) < 0) {
+            swap(*b, *d);
+            if (c(*b, *a) < 0)
+                swap(*a, *b);
+        }
+    }
+
+    // moves the pivot to a[n - 1]
+    static void choosePivot(E* a, int n, F& c) {
+        const int m = n / 2;
+        if (n > NINTHER_LIMIT) {
+            const int s = n / 8;
+            sort3(a, a + s, a + 2 * s, c);
+            sort3(a + m - s, a + m, a + m + s, c);
+            sort3(a + n - 1 - 2 * s, a + n - 1 - s, a + n - 1, c);
+            sort3(a + s, a + m, a + n - 1 - s, c);
+        } else
+            sort3(a, a + m, a + n - 1, c);
+        swap(a[m], a[n - 1]);
+    }
+
+    // Lomuto partition around the pivot in a[n - 1]; returns the final position of the
+    // pivot, the elements satisfying left are before it
+    template<class P>
+    static int partition(E* a, int n, const P& left) {
+        int store = 0;
+        if (IsRelocatable<E>::value) {
+            for (int i = 0; i < n - 1; i++) {
+                const bool l = left(a[i]);
+                swap(a[i], a[store]);
+                store += l;
+            }
+        } else {
+            for (int i = 0; i < n - 1; i++) {
+                if (left(a[i])) {
+                    if (i != store)
+                        swap(a[i], a[store]);
+                    store++;
+                }
+            }
+        }
+        swap(a[store], a[n - 1]);
+        return store;
+    }
+
+    // partitions the range; returns false if only the part after the pivot is left to sort
+    static bool split(E* a, int n, F& c, bool leftmost, int& p) {
+        choosePivot(a, n, c);
+        if (!leftmost && c(a[-1], a[n - 1]) >= 0) {
+            // a[-1] is the pivot of the enclosing range and not less than this one,
+            // so the elements up to this pivot are all equal
+            p = partition(a, n, NotGreater(c, a[n - 1]));
+            return false;
+        }
+        p = partition(a, n, Less(c, a[n - 1]));
+        return true;
+    }
+
+    static void loop(E* a, int n, F& c, int depth, bool leftmost) {
+        while (n > INSERTION_LIMIT) {
+            if (depth-- == 0) {
+                heapSort(a, n, c);
+                return;
+            }
+            int p;
+            if (split(a, n, c, leftmost, p)) {
+                // recurse into the smaller part, iterate on the larger one
+                if (p < n - p - 1) {
+                    loop(a, p, c, depth, leftmost);
+                } else {
+                    loop(a + p + 1, n - p - 1, c, depth, false);
+                    n = p;
+                    continue;
+                }
+            }
+            a += p + 1;
+            n -= p + 1;
+            leftmost = false;
+        }
+        insertionSort(a, n, c);
+    }
+
+    template<class P>
+    static void parallelLoop(E* a, int n, F& c, int depth, bool leftmost, P& pool) {
+        while (n > PARALLEL_LIMIT && depth > 0) {
+            depth--;
+            int p;
+            if (split(a, n, c, leftmost, p) && p > 1) {
+                Task<P>* t = new Task<P>();
+                t->a = a;
+                t->n = p;
+                t->c = &c;
+                t->depth = depth;
+                t->leftmost = leftmost;
+                t->pool = &pool;
+                pool.run(Task<P>::run, t);
+            }
+            a += p + 1;
+            n -= p + 1;
+            leftmost = false;
+        }
+        loop(a, n, c, depth, leftmost);
+    }
+
+    static void insertionSort(E* a, int n, F& c) {
+        for (int i = 1; i < n; i++) {
+            if (c(a[i], a[i - 1]) >= 0)
+                continue;
+            E t(SOM_MOVE(a[i]));
+            int j = i;
+            do {
+                a[j] = SOM_MOVE(a[j - 1]);
+                j--;
+            } while (j > 0 && c(t, a[j - 1]) < 0);
+            a[j] = SOM_MOVE(t);
+        }
+    }
+
+    static void siftDown(E* a, int i, int n, F& c) {
+        E t(SOM_MOVE(a[i]));
+        while (true) {
+            int child = 2 * i + 1;
+            if (child >= n)
+                break;
+            if (child + 1 < n && c(a[child], a[child + 1]) < 0)
+                child++;
+            if (c(t, a[child]) >= 0)
+                break;
+            a[i] = SOM_MOVE(a[child]);
+            i = child;
+        }
+        a[i] = SOM_MOVE(t);
+    }
+
+    static void heapSort(E* a, int n, F& c) {
+        for (int i = n / 2 - 1; i >= 0; i--)
+            siftDown(a, i, n, c);
+        for (int i = n - 1; i > 0; i--) {
+            swap(a[0], a[i]);
+            siftDown(a, 0, i, c);
+        }
+    }
+};
+
+}
+
+#endif // SOM_SORT_H
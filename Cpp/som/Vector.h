@@ -25,17 +25,66 @@
  */
 
 #include <som/Interfaces.h>
+#include <Allocator.h>
+#include <new>
+#include <string.h>
+#include <som/Sort.h>
 
 namespace som {
 
+template<class E, bool relocatable = IsRelocatable<E>::value>
+struct Relocator {
+    // moves n elements from src to the uninitialized dst; src is uninitialized afterwards
+    static void relocate(E* dst, E* src, int n) {
+        for( int i = 0; i < n; i++ )
+        {
+            new(dst + i) E(SOM_MOVE(src[i]));
+            src[i].~E();
+        }
+    }
+};
+
+template<class E>
+struct Relocator<E, true> {
+    static void relocate(E* dst, E* src, int n) {
+        if( n > 0 )
+            memmove((void*)dst, (const void*)src, n * sizeof(E));
+    }
+};
+
+// Forward iterator over the elements of a Vector, from the first to the last one.
+template<class V, class T>
+class VectorIterator {
+    V* v;
+    int idx;
+public:
+    VectorIterator(V* vec, int i):v(vec),idx(i) {}
+    T& operator*() const { return v->storage[v->slot(idx)]; }
+    T* operator->() const { return &v->storage[v->slot(idx)]; }
+    VectorIterator& operator++() { idx++; return *this; }
+    VectorIterator operator++(int) { VectorIterator res(*this); idx++; return res; }
+    bool operator==(const VectorIterator& rhs) const { return idx == rhs.idx && v == rhs.v; }
+    bool operator!=(const VectorIterator& rhs) const { return !(*this == rhs); }
+};
+
+// A ring buffer in raw memory of the current Allocator; only the count elements
+// starting at storage[first] (wrapping around at length) are constructed. Elements
+// can be added and removed at both ends in amortized constant time; indices passed
+// to at() and atPut() are relative to the first element.
 template<class E>
 class Vector {
 private:
     E* storage;
-    int firstIdx;
-    int lastIdx;
+    int first;
+    int count;
     int length;
 
+    int slot(int idx) const
+    {
+        const int i = first + idx;
+        return i >= length ? i - length : i;
+    }
+
     void enlarge(int idx)
     {
         int newLength = length;
@@ -43,164 +92,249 @@ private:
             newLength *= 2;
             newLength += 50;
         }
-        expand(newLength);
+        reallocate(newLength);
+    }
+
+    // the elements move to the front of the new storage
+    void reallocate(int newLength)
+    {
+        if( IsRelocatable<E>::value && first == 0 )
+            storage = (E*)Allocator::reallocate(storage, newLength * sizeof(E));
+        else
+        {
+            E* newStorage = (E*)Allocator::allocate(newLength * sizeof(E));
+            const int head = first + count > length ? length - first : count;
+            Relocator<E>::relocate(newStorage, storage + first, head);
+            Relocator<E>::relocate(newStorage + head, storage, count - head);
+            Allocator::deallocate(storage);
+            storage = newStorage;
+        }
+        first = 0;
+        length = newLength;
+    }
+
+    // constructs the elements from the last one to idx, which gets val
+    void construct(int idx, const E& val)
+    {
+        while( count < idx )
+        {
+            new(storage + slot(count)) E();
+            count++;
+        }
+        new(storage + slot(count)) E(val);
+        count++;
     }
 
 public:
-    Vector(int size = 0):firstIdx(0),lastIdx(0),length(size),storage(0) {
+    Vector(int size = 0):storage(0),first(0),count(0),length(size) {
         if( size )
-            storage = new E[size];
+            storage = (E*)Allocator::allocate(size * sizeof(E));
     }
 
     ~Vector() {
-        if( storage )
-            delete[] storage;
+        removeAll();
+        Allocator::deallocate(storage);
     }
 
     Vector( const Vector<E>& rhs):
-        firstIdx(0),lastIdx(0),length(0),storage(0)
+        storage(0),first(0),count(0),length(0)
     {
         *this = rhs;
     }
 
     Vector<E>& operator=( const Vector<E>& rhs)
     {
-        if( length < rhs.lastIdx )
+        if( this == &rhs )
+            return *this;
+        removeAll();
+        if( length < rhs.count )
         {
             // not enough space to accommodate rhs
-            if( storage )
-                delete[] storage;
-            if( rhs.length )
-                storage = new E[rhs.length];
-            else
-                storage = 0;
-            length = rhs.length;
-        }
-        firstIdx = rhs.firstIdx;
-        lastIdx = rhs.lastIdx;
-        if( rhs.length )
-        {
-            for( int i = firstIdx; i < lastIdx; i++ )
-                storage[i] = rhs.storage[i];
+            Allocator::deallocate(storage);
+            storage = (E*)Allocator::allocate(rhs.count * sizeof(E));
+            length = rhs.count;
         }
+        for( int i = 0; i < rhs.count; i++ )
+            new(storage + i) E(rhs.storage[rhs.slot(i)]);
+        count = rhs.count;
+        return *this;
+    }
+
+#if __cplusplus >= 201103L
+    Vector( Vector<E>&& rhs):storage(rhs.storage),first(rhs.first),count(rhs.count),length(rhs.length)
+    {
+        rhs.storage = 0;
+        rhs.first = rhs.count = rhs.length = 0;
+    }
+
+    Vector<E>& operator=( Vector<E>&& rhs)
+    {
+        if( this == &rhs )
+            return *this;
+        removeAll();
+        Allocator::deallocate(storage);
+        storage = rhs.storage;
+        first = rhs.first;
+        count = rhs.count;
+        length = rhs.length;
+        rhs.storage = 0;
+        rhs.first = rhs.count = rhs.length = 0;
         return *this;
     }
+#endif
 
+    // makes room for newLength elements without constructing any
     void expand(int newLength)
     {
         if( newLength <= length )
             return;
-        E* newStorage = new E[newLength];
-        for( int i = firstIdx; i < lastIdx; i++ )
-            newStorage[i] = storage[i];
-        if( storage )
-            delete[] storage;
-        storage = newStorage;
-        length = newLength;
+        reallocate(newLength);
     }
 
     const E& at(int idx) const {
-        if (idx < 0 || idx >= length) {
+        if (idx < 0 || idx >= count) {
             throw "out of bounds";
         }
-        return storage[idx];
+        return storage[slot(idx)];
     }
 
     E& at(int idx) {
-        if (idx < 0 || idx >= length) {
+        if (idx < 0 || idx >= count) {
             throw "out of bounds";
         }
-        return storage[idx];
+        return storage[slot(idx)];
     }
 
+    // elements between the last one and idx are default constructed
     void atPut(int idx, const E& val) {
-        if (idx >= length)
-            enlarge(idx);
-        storage[idx] = val;
-        if (lastIdx < idx + 1) {
-            lastIdx = idx + 1;
+        if (idx < count) {
+            storage[slot(idx)] = val;
+            return;
         }
+        if (idx >= length) {
+            E tmp(val); // val might be an element of this vector
+            enlarge(idx);
+            construct(idx, tmp);
+        } else
+            construct(idx, val);
     }
 
     void append(const E& elem) {
-        if (lastIdx >= length)
-            enlarge(lastIdx);
+        if (count == length) {
+            E tmp(elem); // elem might be an element of this vector
+            enlarge(count);
+            new(storage + count) E(SOM_MOVE(tmp));
+        } else
+            new(storage + slot(count)) E(elem);
+        count++;
+    }
 
-        storage[lastIdx] = elem;
-        lastIdx++;
+#if __cplusplus >= 201103L
+    void append(E&& elem) {
+        if (count == length) {
+            E tmp(std::move(elem));
+            enlarge(count);
+            new(storage + count) E(std::move(tmp));
+        } else
+            new(storage + slot(count)) E(std::move(elem));
+        count++;
+    }
+#endif
+
+    void prepend(const E& elem) {
+        if (count == length) {
+            E tmp(elem); // elem might be an element of this vector
+            enlarge(count);
+            first = length - 1;
+            new(storage + first) E(SOM_MOVE(tmp));
+        } else {
+            first = first == 0 ? length - 1 : first - 1;
+            new(storage + first) E(elem);
+        }
+        count++;
     }
 
     bool isEmpty() const {
-        return lastIdx == firstIdx;
+        return count == 0;
     }
 
     void forEach(ForEachInterface<E>& fn) {
-        for (int i = firstIdx; i < lastIdx; i++) {
-            fn.apply(storage[i]);
+        for (int i = 0, j = first; i < count; i++) {
+            fn.apply(storage[j]);
+            if (++j == length)
+                j = 0;
         }
     }
 
     bool hasSome(TestInterface<E>& fn) const {
-        for (int i = firstIdx; i < lastIdx; i++) {
-            if (fn.test(storage[i])) {
+        for (int i = 0, j = first; i < count; i++) {
+            if (fn.test(storage[j])) {
                 return true;
             }
+            if (++j == length)
+                j = 0;
         }
         return false;
     }
 
-    E& removeFirst() {
+    E removeFirst() {
         if (isEmpty()) {
             throw "empty";
         }
-        firstIdx++;
-        return storage[firstIdx - 1];
+        E res(SOM_MOVE(storage[first]));
+        storage[first].~E();
+        count--;
+        first = count == 0 || first + 1 == length ? 0 : first + 1;
+        return res;
     }
 
-    bool remove(const E& obj) {
-        if( length == 0 )
-            return false;
-
-        E* newArray = new E[length];
-
-        struct Iterator : public ForEachInterface<E>
-        {
-            Iterator(E* a, const E* o):newArray(a),newLast(0),found(false),obj(o){}
-            E* newArray;
-            int newLast;
-            const E* obj;
-            bool found;
-            void apply(const E& it)
-            {
-                if (it == *obj) {
-                    found = true;
-                } else {
-                    newArray[newLast] = it;
-                    newLast++;
-                }
-            }
-        } it(newArray, &obj);
-        forEach(it);
+    E removeLast() {
+        if (isEmpty()) {
+            throw "empty";
+        }
+        const int last = slot(count - 1);
+        E res(SOM_MOVE(storage[last]));
+        storage[last].~E();
+        count--;
+        if (count == 0)
+            first = 0;
+        return res;
+    }
 
-        delete[] storage;
-        storage  = newArray;
-        lastIdx  = it.newLast;
-        firstIdx = 0;
-        return it.found;
+    // removes all elements equal to obj in place, keeping the order of the others
+    bool remove(const E& obj) {
+        const E key(obj); // obj might be an element of this vector
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            E& e = storage[slot(i)];
+            if (e == key)
+                continue;
+            if (kept != i)
+                storage[slot(kept)] = SOM_MOVE(e);
+            kept++;
+        }
+        const bool found = kept != count;
+        for (int i = kept; i < count; i++)
+            storage[slot(i)].~E();
+        count = kept;
+        if (count == 0)
+            first = 0;
+        return found;
     }
 
+    // keeps the storage
     void removeAll() {
-        firstIdx = 0;
-        lastIdx = 0;
-        if( length )
-        {
-            delete[] storage;
-            storage = new E[length];
+        for (int i = 0, j = first; i < count; i++) {
+            storage[j].~E();
+            if (++j == length)
+                j = 0;
         }
+        first = 0;
+        count = 0;
     }
 
     int size() const {
-        return lastIdx - firstIdx;
+        return count;
     }
 
     int capacity() const {
@@ -208,82 +342,86 @@ public:
     }
 
     void sort( const Comparator<E>& c) {
-        if (size() > 0) {
-            sort(firstIdx, lastIdx - 1, c);
-        }
+        sort(0, count - 1, c);
     }
 
     void sort(int i, int j, const Comparator<E>& c) {
-#if 0
-        if (c == 0) {
-            defaultSort(i, j);
-        }
-#endif
-
-        int n = j + 1 - i;
-        if (n <= 1) {
-            return;
-        }
-
-        E di = storage[i];
-        E dj = storage[j];
-
-        if (c.compare(di, dj) > 0) {
-            swap(storage, i, j);
-            E tt = di;
-            di = dj;
-            dj = tt;
-        }
-
-        if (n > 2) {
-            int ij = (i + j) / 2;
-            E dij = storage[ij];
-
-            if (c.compare(di, dij) <= 0) {
-                if (c.compare(dij, dj) > 0) {
-                    swap(storage, j, ij);
-                    dij = dj;
-                }
-            } else {
-                swap(storage, i, ij);
-                dij = di;
-            }
+        VirtualCompare vc(c);
+        sortRange(i, j, vc);
+    }
 
-            if (n > 3) {
-                int k = i;
-                int l = j - 1;
+    template<class F>
+    typename EnableIf<!IsInterface<F, E>::value>::Type sort(F c) {
+        sortRange(0, count - 1, c);
+    }
 
-                while (true) {
-                    while (k <= l && c.compare(dij, storage[l]) <= 0) {
-                        l -= 1;
-                    }
+    // sorts large vectors in parallel on the pool; c is called concurrently, and the
+    // caller has to include Thread.h
+    void sort(const Comparator<E>& c, ThreadPool& pool) {
+        VirtualCompare vc(c);
+        sortRange(0, count - 1, vc, &pool);
+    }
 
-                    k += 1;
-                    while (k <= l && c.compare( storage[k], dij) <= 0) {
-                        k += 1;
-                    }
+    template<class F>
+    typename EnableIf<!IsInterface<F, E>::value>::Type sort(F c, ThreadPool& pool) {
+        sortRange(0, count - 1, c, &pool);
+    }
 
-                    if (k > l) {
-                        break;
-                    }
-                    swap(storage, k, l);
-                }
+    template<class F>
+    typename EnableIf<!IsInterface<F, E>::value>::Type forEach(F fn) {
+        for (int i = 0, j = first; i < count; i++) {
+            fn(storage[j]);
+            if (++j == length)
+                j = 0;
+        }
+    }
 
-                sort(i, l, c);
-                sort(k, j, c);
+    template<class F>
+    typename EnableIf<!IsInterface<F, E>::value, bool>::Type hasSome(F fn) const {
+        for (int i = 0, j = first; i < count; i++) {
+            if (fn(storage[j])) {
+                return true;
             }
+            if (++j == length)
+                j = 0;
         }
+        return false;
     }
 
-    static void swap(E* storage2, int i, int j) {
-        throw "NotImplemented";
-    }
+    typedef VectorIterator<Vector<E>, E> iterator;
+    typedef VectorIterator<const Vector<E>, const E> const_iterator;
 
-    static void defaultSort(int i, int j) {
-        throw "NotImplemented";
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+private:
+    template<class V, class T> friend class VectorIterator;
+
+    struct VirtualCompare {
+        const Comparator<E>& c;
+        VirtualCompare(const Comparator<E>& cmp):c(cmp) {}
+        int operator()(const E& lhs, const E& rhs) const { return c.compare(lhs, rhs); }
+    };
+
+    // i and j are relative to the first element
+    template<class F>
+    void sortRange(int i, int j, F& c, ThreadPool* pool = 0) {
+        if (i < 0 || j >= count || j <= i)
+            return;
+        if (first + count > length)
+            reallocate(length); // make the elements contiguous
+        if (pool)
+            Sorter<E, F>::sort(storage + first + i, j - i + 1, c, *pool);
+        else
+            Sorter<E, F>::sort(storage + first + i, j - i + 1, c);
     }
 };
 
+template<class E>
+struct IsRelocatable<Vector<E> > { enum { value = true }; };
+
 }
 
 #endif // SOM_VECTOR_H